@@ -23,6 +23,7 @@
 //----------------------------------------------------------------------------------
 
 #include <avr/io.h>
+#include <avr/interrupt.h>
 #include <util/twi.h>
 #include <util/delay.h>
 
@@ -31,6 +32,74 @@
 #define TWI_SCL PORTC0
 #define TWI_SDA PORTC1
 
+// TWCR values to continue with the next bus operation and to release the bus.
+#define TWI_CONTINUE    ((1 << TWINT) | (1 << TWEN) | (1 << TWIE))
+#define TWI_STOP        ((1 << TWINT) | (1 << TWEN) | (1 << TWSTO))
+
+// State of the interrupt driven TWI state machine.
+static volatile unsigned char twiBusy = 0;
+static volatile unsigned char twiStatus = RET_SUCCESS;
+static volatile unsigned char twiData = 0;
+
+static struct I2CMessage *twiMessages = 0;
+static unsigned char twiMessageCount = 0;
+static unsigned char twiMessageIndex = 0;
+
+// Timer1 tick of the last bus progress and whether the last issued operation is START.
+static volatile unsigned short twiProgressTick = 0;
+static volatile unsigned char twiStartIssued = 0;
+
+// Timeout limits in Timer1 ticks (ref: I2C_TIMEOUT_* selectors).
+static unsigned short timeoutTicks[4] = {I2C_TIMER_TICKS(I2C_DEFAULT_START_TIMEOUT), I2C_TIMER_TICKS(I2C_DEFAULT_STRETCH_TIMEOUT),
+    I2C_TIMER_TICKS(I2C_DEFAULT_COMMAND_TIMEOUT), I2C_TIMER_TICKS(I2C_DEFAULT_BATCH_TIMEOUT)};
+
+// Bus counters, arbitration lost is updated by the TWI interrupt.
+static struct I2CStatistics twiStats;
+static volatile unsigned short twiArbitrationLost = 0;
+
+// Start tick and length of the deadline of the current command.
+static unsigned short deadlineTick = 0;
+static unsigned short deadlineTicks = I2C_TIMER_TICKS(I2C_DEFAULT_COMMAND_TIMEOUT);
+
+unsigned short i2cTimerTick()
+{
+    unsigned char sreg = SREG;
+    unsigned short tick;
+
+    // TWI interrupt also reads TCNT1, which shares the 16-bit TEMP register.
+    cli();
+    tick = TCNT1;
+    SREG = sreg;
+
+    return tick;
+}
+
+void i2cInitTimer()
+{
+    // Timer1 in normal mode with 1024 prescaler, used as free running time base.
+    TCCR1A = 0x00;
+    TCCR1B = ((1 << CS12) | (1 << CS10));
+}
+
+unsigned char i2cSetTimeout(unsigned char selector, unsigned short timeout)
+{
+    if((selector > I2C_TIMEOUT_BATCH) || (timeout == 0) || (timeout > I2C_TIMEOUT_MAX_MS))
+    {
+        // Unknown selector or timeout is out of range of the Timer1.
+        return RET_UNKNOWN;
+    }
+
+    timeoutTicks[selector] = I2C_TIMER_TICKS(timeout);
+    return RET_SUCCESS;
+}
+
+void i2cStartDeadline(unsigned char selector)
+{
+    // Deadline of the command starts from now.
+    deadlineTick = i2cTimerTick();
+    deadlineTicks = timeoutTicks[(selector == I2C_TIMEOUT_BATCH) ? I2C_TIMEOUT_BATCH : I2C_TIMEOUT_COMMAND];
+}
+
 void i2cInit(unsigned char comSpeed)
 {
     // Setup I/O pin for I2C with pull-ups.
@@ -66,129 +135,309 @@ void i2cInit(unsigned char comSpeed)
     }    
 }
 
-unsigned char i2cStart(void (*usbProc)(void))
+static void twiContinue()
 {
-    unsigned short timeout = 0;
-    
-    // Send START condition to the slave device.
-    TWCR =  ((1 << TWINT) | (1 << TWEN) | (1 << TWSTA));
+    struct I2CMessage *msg;
 
-    while (!(TWCR & (1 << TWINT)))
+    while(twiMessageIndex < twiMessageCount)
     {
-        if((++timeout) >= I2C_TIMEOUT)
+        msg = &twiMessages[twiMessageIndex];
+        if(msg->done < msg->length)
         {
-            // Delay timeout has occured.
-            return RET_TIMEOUT_FAIL;
+            if(msg->addr & 0x01)
+            {
+                // Receive next byte, send ACK for all the bytes except the last one (unless requested).
+                TWCR = TWI_CONTINUE | (((msg->done < (msg->length - 1)) || (msg->flags & I2C_MSG_LAST_ACK)) ? (1 << TWEA) : 0);
+            }
+            else
+            {
+                // Transmit next byte of the message.
+                TWDR = msg->data[msg->done];
+                TWCR = TWI_CONTINUE;
+            }
+
+            return;
         }
 
-        _delay_us(I2C_DELAY_DELTA);
-        (*usbProc)();
+        // Current message is complete, move to the next message.
+        if((++twiMessageIndex < twiMessageCount) && !(twiMessages[twiMessageIndex].flags & I2C_MSG_NO_START))
+        {
+            // Send repeated START for the next message.
+            twiStartIssued = 1;
+            TWCR = TWI_CONTINUE | (1 << TWSTA);
+            return;
+        }
     }
 
-    // Send I2C status to the host system.
-    return TW_STATUS;
+    if(twiMessages[twiMessageCount - 1].flags & I2C_MSG_NO_STOP)
+    {
+        // Leave TWINT set to hold the bus until the next command of the host.
+        twiBusy = 0;
+        return;
+    }
+
+    // All the messages are transferred, release the bus.
+    TWCR = TWI_STOP;
+    twiBusy = 0;
 }
 
-unsigned char i2cWriteAddr(void (*usbProc)(void), unsigned char addr)
+// TWINT is not cleared by the hardware on vector entry. This stub masks TWIE and re-enable 
+// global interrupts before entering the state machine, so V-USB interrupt is never delayed.
+ISR(TWI_vect, ISR_NAKED)
 {
-    unsigned short timeout = 0;
+    asm volatile(
+        "push r24"                  "\n\t"
+        "ldi r24, %[twiMask]"       "\n\t"
+        "out %[twiControl], r24"    "\n\t"
+        "pop r24"                   "\n\t"
+        "sei"                       "\n\t"
+        "jmp __vector_twi_service"  "\n\t"
+        :: [twiMask] "M" (1 << TWEN), [twiControl] "I" (_SFR_IO_ADDR(TWCR)));
+}
+
+// TWI state machine, compiled with the complete interrupt prologue and epilogue.
+void __vector_twi_service(void) __attribute__((signal, used, externally_visible));
+void __vector_twi_service(void)
+{
+    struct I2CMessage *msg;
     
-    // Set device address with read/write flag.
-    TWDR = addr;
-    TWCR = ((1 << TWINT) | (1 << TWEN));
+    twiStatus = TW_STATUS;
+    twiData = TWDR;
+    twiProgressTick = TCNT1;
+    twiStartIssued = 0;
 
-    while (!(TWCR & (1 << TWINT)))
+    if(twiStatus == TW_MT_ARB_LOST)
     {
-        if((++timeout) >= I2C_TIMEOUT)
-        {
-            // Delay timeout has occured.
-            return RET_TIMEOUT_FAIL;
-        }
+        twiArbitrationLost++;
+    }
 
-        _delay_us(I2C_DELAY_DELTA);
-        (*usbProc)();
+    if(twiMessages == 0)
+    {
+        // Single bus operation is completed.
+        twiBusy = 0;
+        return;
     }
 
-    // Send I2C status to the host system.
-    return TW_STATUS;
+    msg = &twiMessages[twiMessageIndex];
+    switch(twiStatus)
+    {
+    case TW_START:
+    case TW_REP_START:
+        // Send slave address with read/write flag of the current message.
+        TWDR = msg->addr;
+        TWCR = TWI_CONTINUE;
+        break;
+    case TW_MT_DATA_ACK:
+        // Data byte is accepted by the slave device.
+        msg->done++;
+        twiContinue();
+        break;
+    case TW_MR_DATA_ACK:
+    case TW_MR_DATA_NACK:
+        // Data byte is received from the slave device.
+        msg->data[msg->done++] = twiData;
+        twiContinue();
+        break;
+    case TW_MT_SLA_ACK:
+    case TW_MR_SLA_ACK:
+        // Slave device is addressed, continue with the data bytes.
+        twiContinue();
+        break;
+    case TW_MT_DATA_NACK:
+        if(twiMessages[twiMessageCount - 1].flags & I2C_MSG_NO_STOP)
+        {
+            // Data byte is rejected, leave the bus to the host as same as the single write command.
+            twiBusy = 0;
+            break;
+        }
+        // fall through
+    default:
+        // NACK, arbitration lost or bus error. Release the bus and abort the transaction.
+        TWCR = (twiStatus == TW_MT_ARB_LOST) ? ((1 << TWINT) | (1 << TWEN)) : TWI_STOP;
+        twiBusy = 0;
+    }
 }
 
-unsigned char i2cWrite(void (*usbProc)(void), unsigned char data)
+static unsigned char i2cWait(void (*usbProc)(void))
 {
-    unsigned short timeout = 0;
-    
-    // Write specified data into slave device.
-    TWDR = data;
-    TWCR = ((1 << TWINT) | (1 << TWEN));
+    unsigned short currentTick;
 
-    while (!(TWCR & (1 << TWINT)))
+    // Service USB until the TWI state machine completes the operation.
+    while(twiBusy)
     {
-        if((++timeout) >= I2C_TIMEOUT)
+        currentTick = i2cTimerTick();
+        twiStats.waitIterations++;
+
+        if((unsigned short)(currentTick - twiProgressTick) >= timeoutTicks[twiStartIssued ? I2C_TIMEOUT_START : I2C_TIMEOUT_STRETCH])
         {
-            // Delay timeout has occured.
+            // Bus is not free to send START, or slave device holds the clock for too long.
+            TWCR = (1 << TWEN);
+            twiBusy = 0;
+
+            if(twiStartIssued)
+            {
+                twiStats.busBusy++;
+                return RET_BUS_BUSY_FAIL;
+            }
+
+            twiStats.timeouts++;
+            return RET_TIMEOUT_FAIL;
+        }
+
+        if((unsigned short)(currentTick - deadlineTick) >= deadlineTicks)
+        {
+            // Deadline of the command has expired.
+            TWCR = (1 << TWEN);
+            twiBusy = 0;
+            twiStats.timeouts++;
             return RET_TIMEOUT_FAIL;
         }
 
-        _delay_us(I2C_DELAY_DELTA);
         (*usbProc)();
     }
 
     // Send I2C status to the host system.
-    return TW_STATUS;
+    return twiStatus;
+}
+
+static unsigned char i2cExecute(void (*usbProc)(void), unsigned char control)
+{
+    // Start single bus operation, TWI interrupt signals the completion.
+    twiMessages = 0;
+    twiStartIssued = ((control & (1 << TWSTA)) != 0);
+    twiProgressTick = i2cTimerTick();
+    twiBusy = 1;
+    TWCR = TWI_CONTINUE | control;
+    
+    return i2cWait(usbProc);
+}
+
+unsigned char i2cStart(void (*usbProc)(void))
+{
+    // Send START condition to the slave device.
+    return i2cExecute(usbProc, (1 << TWSTA));
+}
+
+unsigned char i2cWriteAddr(void (*usbProc)(void), unsigned char addr)
+{
+    // Set device address with read/write flag.
+    TWDR = addr;
+    return i2cExecute(usbProc, 0);
+}
+
+unsigned char i2cWrite(void (*usbProc)(void), unsigned char data)
+{
+    // Write specified data into slave device.
+    TWDR = data;
+    return i2cExecute(usbProc, 0);
 }
 
 unsigned char i2cRead(void (*usbProc)(void), unsigned char ack, unsigned char *data)
 {
-    unsigned short timeout = 0;
-    *data = 0;
+    unsigned char status;
 
-    if(ack)
-    {
-        // Send ACK after the successful read.
-        TWCR = ((1 << TWINT) | (1 << TWEN) | (1 << TWEA));
-        
-        while (!(TWCR & (1 << TWINT)))
-        {
-            if((++timeout) >= I2C_TIMEOUT)
-            {
-                // Delay timeout has occured.
-                return RET_TIMEOUT_FAIL;
-            }
+    // Send ACK after the successful read, if requested.
+    status = i2cExecute(usbProc, (ack ? (1 << TWEA) : 0));
+    *data = (status == RET_TIMEOUT_FAIL) ? 0 : twiData;
 
-            _delay_us(I2C_DELAY_DELTA);
-            (*usbProc)();
-        }
+    return status;
+}
 
-        *data = TWDR;
+unsigned char i2cTransfer(void (*usbProc)(void), struct I2CMessage *messages, unsigned char count)
+{
+    unsigned char status, msgPos;
 
-        // Send I2C status to the host system.
-        return TW_STATUS;
+    for(msgPos = 0; msgPos < count; msgPos++)
+    {
+        messages[msgPos].done = 0;
     }
-    else
+
+    twiMessages = messages;
+    twiMessageCount = count;
+    twiMessageIndex = 0;
+    twiProgressTick = i2cTimerTick();
+
+    if(messages[0].flags & I2C_MSG_NO_START)
     {
-        // ACK is not sent after the successful read.
-        TWCR = ((1 << TWINT) | (1 << TWEN));
-        while (!(TWCR & (1 << TWINT)))
+        // Continue the transaction addressed by the previous commands, bus must be in the same direction.
+        status = TW_STATUS;
+        if(!((messages[0].addr & 0x01) ? ((status == TW_MR_SLA_ACK) || (status == TW_MR_DATA_ACK)) : 
+            ((status == TW_MT_SLA_ACK) || (status == TW_MT_DATA_ACK))))
         {
-             if((++timeout) >= I2C_TIMEOUT)
-            {
-                // Delay timeout has occured.
-                return RET_TIMEOUT_FAIL;
-            }
-
-            _delay_us(I2C_DELAY_DELTA);
-            (*usbProc)();           
+            twiMessages = 0;
+            return RET_UNKNOWN;
         }
 
-        *data = TWDR;
+        // TWI interrupt is masked at this point, so the state machine can be started from here.
+        twiStartIssued = 0;
+        twiBusy = 1;
+        twiContinue();
+    }
+    else
+    {
+        // Send START and let the TWI interrupt chain all the messages at wire speed.
+        twiStartIssued = 1;
+        twiBusy = 1;
+        TWCR = TWI_CONTINUE | (1 << TWSTA);
+    }
 
-        // Send I2C status to the host system.
-        return TW_STATUS;
+    status = i2cWait(usbProc);
+    if((status == RET_TIMEOUT_FAIL) || (status == RET_BUS_BUSY_FAIL))
+    {
+        // Try to release the bus.
+        i2cStop();
     }
+
+    twiMessages = 0;
+    return status;
+}
+
+unsigned char i2cIsIdle()
+{
+    // Bus is released by a STOP condition (or never used) and not held by the host.
+    return ((!twiBusy) && (TW_STATUS == TW_NO_INFO));
+}
+
+unsigned char i2cProbe(void (*usbProc)(void), unsigned char addr)
+{
+    struct I2CMessage probeMessage;
+
+    // Zero length write message: START | SLA+W | STOP
+    probeMessage.addr = (addr << 1);
+    probeMessage.flags = 0;
+    probeMessage.length = 0;
+    probeMessage.data = 0;
+
+    return i2cTransfer(usbProc, &probeMessage, 1);
 }
 
 void i2cStop()
 {
     // Send STOP condition to the device / bus.
     TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWSTO);
+}
+
+void i2cGetStatistics(struct I2CStatistics *stats)
+{
+    unsigned char sreg = SREG;
+
+    *stats = twiStats;
+
+    // Arbitration lost counter is shared with the TWI interrupt.
+    cli();
+    stats->arbitrationLost = twiArbitrationLost;
+    SREG = sreg;
+}
+
+void i2cResetStatistics()
+{
+    unsigned char sreg = SREG;
+
+    twiStats.waitIterations = 0;
+    twiStats.timeouts = 0;
+    twiStats.busBusy = 0;
+
+    cli();
+    twiArbitrationLost = 0;
+    SREG = sreg;
 }
\ No newline at end of file
@@ -28,16 +28,62 @@
 #define RET_SUCCESS         0x00
 #define RET_PENDING         0x01
 #define RET_UNKNOWN         0x02
+#define RET_QUEUE_FULL      0xFD
+#define RET_BUS_BUSY_FAIL   0xFE
 #define RET_TIMEOUT_FAIL    0xFF
 
-#define I2C_TIMEOUT     0x7FF
 #define I2C_DELAY_DELTA     500
 
+// Timeout selectors.
+#define I2C_TIMEOUT_START   0   // Wait for the bus to be free / arbitration to transmit START.
+#define I2C_TIMEOUT_STRETCH 1   // Wait for the slave device to release the clock for a single transfer.
+#define I2C_TIMEOUT_COMMAND 2   // Deadline of a single bus command.
+#define I2C_TIMEOUT_BATCH   3   // Deadline of a batch or compound command.
+
+// Timer1 runs at F_CPU/1024, 16-bit counter overflows after ~4.19 seconds at 16MHz.
+#define I2C_TIMER_TICKS(ms) ((unsigned short)(((unsigned long)(ms) * (F_CPU / 1024UL)) / 1000UL))
+#define I2C_TIMEOUT_MAX_MS  4000
+
+// Default timeout values in milliseconds.
+#define I2C_DEFAULT_START_TIMEOUT   50
+#define I2C_DEFAULT_STRETCH_TIMEOUT 25
+#define I2C_DEFAULT_COMMAND_TIMEOUT 100
+#define I2C_DEFAULT_BATCH_TIMEOUT   1000
+
 // I2C speed configurations.
 #define TWI_COM_SPEED_100   0   // 100kHz
 #define TWI_COM_SPEED_250   1   // 250kHz
 #define TWI_COM_SPEED_400   2   // 400kHz
 
+// Message flags.
+#define I2C_MSG_NO_START    0x01    // Continue without (repeated) START and slave address.
+#define I2C_MSG_NO_STOP     0x02    // Keep the bus after the last message, transaction is continued by the host.
+#define I2C_MSG_LAST_ACK    0x04    // Send ACK for the last received byte of the message.
+
+// Single message of the I2C transaction. (similar to struct i2c_msg of the Linux kernel)
+struct I2CMessage
+{
+    unsigned char addr;             // Slave address with read/write flag.
+    unsigned char flags;
+    unsigned char length;
+    volatile unsigned char done;    // Number of data bytes transferred.
+    unsigned char *data;
+};
+
+// Bus counters of the driver, reported to the host with the performance counters (ref: USB_CMD_GET_STATS).
+struct I2CStatistics
+{
+    unsigned long waitIterations;   // Iterations of the completion wait loop.
+    unsigned short timeouts;        // Clock stretch and command deadline timeouts.
+    unsigned short busBusy;         // START is not transmitted within the start timeout.
+    unsigned short arbitrationLost;
+};
+
+void i2cInitTimer();
+unsigned short i2cTimerTick();
+unsigned char i2cSetTimeout(unsigned char selector, unsigned short timeout);
+void i2cStartDeadline(unsigned char selector);
+
 void i2cInit(unsigned char comSpeed);
 unsigned char i2cStart(void (*usbProc)(void));
 void i2cStop();
@@ -46,4 +92,11 @@ unsigned char i2cWriteAddr(void (*usbProc)(void), unsigned char addr);
 unsigned char i2cWrite(void (*usbProc)(void), unsigned char data);
 unsigned char i2cRead(void (*usbProc)(void), unsigned char ack, unsigned char *data);
 
+unsigned char i2cTransfer(void (*usbProc)(void), struct I2CMessage *messages, unsigned char count);
+unsigned char i2cIsIdle();
+unsigned char i2cProbe(void (*usbProc)(void), unsigned char addr);
+
+void i2cGetStatistics(struct I2CStatistics *stats);
+void i2cResetStatistics();
+
 #endif /* I2C_DRIVER_HEADER */
\ No newline at end of file
@@ -26,13 +26,15 @@
 #include <avr/interrupt.h>
 #include <util/delay.h>
 #include <avr/wdt.h>
+#include <util/twi.h>
 
 #include "usbdrv.h"
 
 #include "i2ctester.h"
 #include "i2cdrv.h"
+#include "sampler.h"
 
-PROGMEM const char usbHidReportDescriptor[22] = {    /* USB report descriptor */
+PROGMEM const char usbHidReportDescriptor[28] = {    /* USB report descriptor */
     0x06, 0x00, 0xff,              //   USAGE_PAGE (Generic Desktop)
     0x09, 0x01,                    //   USAGE (Vendor Usage 1)
     0xa1, 0x01,                    //   COLLECTION (Application)
@@ -42,6 +44,9 @@ PROGMEM const char usbHidReportDescriptor[22] = {    /* USB report descriptor */
     0x95, 0x80,                    //   REPORT_COUNT (128)
     0x09, 0x00,                    //   USAGE (Undefined)
     0xb2, 0x02, 0x01,              //   FEATURE (Data,Var,Abs,Buf)
+    0x95, 0x08,                    //   REPORT_COUNT (8)
+    0x09, 0x00,                    //   USAGE (Undefined)
+    0x81, 0x02,                    //   INPUT (Data,Var,Abs)
     0xc0                           //   END_COLLECTION
 };
 
@@ -49,11 +54,11 @@ int main()
 {
     unsigned char connectDelay = 0;
     unsigned char outputVoltage = I2C_OUTPUT_3V3;
+    unsigned char *cmdSlot;
     
     // Initialize system registers and global variables.
     wdt_disable();
     initSystem();
-    clearRequestBuffer();
 
     // Check device is connected to the USB host.
     if((PINA & 0x01) == 0x00)
@@ -93,6 +98,9 @@ int main()
 
     // Switch on lowest possible output voltage.
     setOutputVoltage(I2C_OUTPUT_3V3, &outputVoltage);
+
+    // Performance counters start with the main service loop.
+    resetStatistics();
     
     // Main service loop.
     while(1)
@@ -109,19 +117,40 @@ int main()
             while(1);
         }
         
-        // Process pending USB messages and clear request buffer.
-        if((reqBuffer[0] == SYS_SIGNATURE) && (reqBuffer[1] != USB_CMD_NONE))
+        // Execute the oldest queued command. New requests keep arriving into the free slots while
+        // this command is on the I2C bus.
+        if(execHead != recvHead)
         {
-            switch(reqBuffer[1])
+            cmdSlot = cmdQueue[execHead & CMD_QUEUE_MASK];
+            
+            lastCommand = cmdSlot[1];
+            lastCommandStatus = RET_PENDING;
+            lastCommandData = 0x00;
+
+            // Response payload overwrites the request payload, commands fetch their arguments first.
+            respPayload = &cmdSlot[USB_RESP_HEADER_SIZE];
+            respPayloadLength = 0;
+
+            // Count the dispatched commands by opcode.
+            if((cmdSlot[1] != USB_CMD_NONE) && (cmdSlot[1] <= STATS_OPCODE_COUNT))
+            {
+                statCommands[cmdSlot[1] - 1]++;
+            }
+
+            // Batch, compound register and bulk commands run under the batch deadline.
+            i2cStartDeadline(((cmdSlot[1] == USB_CMD_BATCH) || (cmdSlot[1] == USB_CMD_I2C_READ_REG) || (cmdSlot[1] == USB_CMD_I2C_WRITE_REG) 
+                || (cmdSlot[1] == USB_CMD_I2C_READ_BULK) || (cmdSlot[1] == USB_CMD_I2C_WRITE_BULK)) ? I2C_TIMEOUT_BATCH : I2C_TIMEOUT_COMMAND);
+
+            switch(cmdSlot[1])
             {
             case USB_CMD_I2C_INIT:
                 // Initialize I2C session.
-                i2cInit(reqBuffer[2]);   // DATA0 - I2C communication speed (ref: i2cdrv.h)
+                i2cInit(cmdSlot[2]);   // DATA0 - I2C communication speed (ref: i2cdrv.h)
                 lastCommandStatus = RET_SUCCESS;
                 break;
             case USB_CMD_I2C_START:
                 // Send I2C start command.
-                lastCommandStatus = i2cStart(usbPoll);
+                lastCommandStatus = i2cStart(servicePoll);
                 break;
             case USB_CMD_I2C_STOP:
                 // Send I2C stop command.
@@ -130,19 +159,19 @@ int main()
                 break;
             case USB_CMD_I2C_WRITE_ADDR:
                 // Send I2C write address command.
-                lastCommandStatus = i2cWriteAddr(usbPoll, reqBuffer[2]);  // DATA0 - slave device address and read/write flag.
+                lastCommandStatus = i2cWriteAddr(servicePoll, cmdSlot[2]);  // DATA0 - slave device address and read/write flag.
                 break;
             case USB_CMD_I2C_WRITE:
                 // Send I2C write command.
-                lastCommandStatus = i2cWrite(usbPoll, reqBuffer[2]);  // DATA0 - data to write into slave device.
+                lastCommandStatus = i2cWrite(servicePoll, cmdSlot[2]);  // DATA0 - data to write into slave device.
                 break;
             case USB_CMD_I2C_READ:
                 // Send I2C read command.
-                lastCommandStatus = i2cRead(usbPoll, reqBuffer[2], &lastCommandData); // DATA0 - ACK status for read command.            
+                lastCommandStatus = i2cRead(servicePoll, cmdSlot[2], &lastCommandData); // DATA0 - ACK status for read command.            
                 break;
             case USB_CMD_SET_VOLTAGE:
                 // Set I2C output voltage.                
-                lastCommandStatus = setOutputVoltage(reqBuffer[2], &outputVoltage); // DATA0 - Voltage level, 0x01 - 5V; 0x02 - 3.3V;
+                lastCommandStatus = setOutputVoltage(cmdSlot[2], &outputVoltage); // DATA0 - Voltage level, 0x01 - 5V; 0x02 - 3.3V;
                 break;
             case USB_CMD_GET_VOLTAGE:
                 // Get current I2C output voltage.
@@ -152,18 +181,87 @@ int main()
             case USB_CMD_RESET:
                 // Reset I2C slave device and I2C terminal registers.
                 lastCommandStatus = resetI2CSlave(outputVoltage);
-                break;            
+                break;
+            case USB_CMD_BATCH:
+                // Execute sequence of I2C operations.
+                lastCommandStatus = execBatch(cmdSlot[2], &cmdSlot[USB_REQ_HEADER_SIZE]);  // DATA0 - number of operations.
+                break;
+            case USB_CMD_I2C_READ_REG:
+                // Read specified number of bytes from the slave register.
+                lastCommandStatus = execReadRegister(cmdSlot[2], cmdSlot[USB_REQ_HEADER_SIZE], cmdSlot[USB_REQ_HEADER_SIZE + 1]);  // DATA0 - 7-bit slave address.
+                break;
+            case USB_CMD_I2C_WRITE_REG:
+                // Write specified bytes into the slave register.
+                lastCommandStatus = execWriteRegister(cmdSlot[2], cmdSlot[USB_REQ_HEADER_SIZE], cmdSlot[USB_REQ_HEADER_SIZE + 1], &cmdSlot[USB_REQ_HEADER_SIZE + 2]);  // DATA0 - 7-bit slave address.
+                break;
+            case USB_CMD_SET_TIMEOUT:
+                // Set bus timeout, value is in milliseconds (LSB first).
+                lastCommandStatus = i2cSetTimeout(cmdSlot[2], cmdSlot[USB_REQ_HEADER_SIZE] | (cmdSlot[USB_REQ_HEADER_SIZE + 1] << 8));  // DATA0 - timeout selector (ref: i2cdrv.h)
+                break;
+            case USB_CMD_I2C_SCAN:
+                // Probe all the slave addresses and return the presence bitmap.
+                lastCommandStatus = execScanBus();
+                break;
+            case USB_CMD_I2C_READ_BULK:
+                // Read specified number of bytes from the addressed slave device.
+                lastCommandStatus = execReadBulk(cmdSlot[2], cmdSlot[USB_REQ_HEADER_SIZE]);  // DATA0 - number of bytes to read.
+                break;
+            case USB_CMD_I2C_WRITE_BULK:
+                // Write specified bytes into the addressed slave device.
+                lastCommandStatus = execWriteBulk(cmdSlot[2], &cmdSlot[USB_REQ_HEADER_SIZE]);  // DATA0 - number of bytes to write.
+                break;
+            case USB_CMD_SAMPLE_CONFIG:
+                // Set sampling period and the list of registers, active sampling is stopped.
+                lastCommandStatus = samplerConfigure(cmdSlot[2], &cmdSlot[USB_REQ_HEADER_SIZE]);  // DATA0 - number of registers.
+                break;
+            case USB_CMD_SAMPLE_CONTROL:
+                // Start or stop the timer driven sampling.
+                lastCommandStatus = samplerControl(cmdSlot[2]);  // DATA0 - 0x01 to start, 0x00 to stop.
+                break;
+            case USB_CMD_SAMPLE_READ:
+                // Drain the buffered sample frames, DATA0 of the response contains the number of frames.
+                respPayloadLength = samplerRead(respPayload, (USB_REPORT_SIZE - USB_RESP_HEADER_SIZE), &lastCommandData);
+                lastCommandStatus = RET_SUCCESS;
+                break;
+            case USB_CMD_GET_STATS:
+                // Report the performance counters, counters are cleared after the report if requested.
+                lastCommandStatus = execGetStats(cmdSlot[2]);  // DATA0 - 0x01 to reset the counters.
+                break;
             default:
                 // Unknown command ID.
                 lastCommandStatus = RET_UNKNOWN;
             }
 
-            // Clear request buffer.
-            clearRequestBuffer();
+            // Rewrite the slot header into the response header: SIGNATURE | COMMAND | STATUS | DATA0 | TAG
+            cmdSlot[2] = lastCommandStatus;
+            cmdSlot[3] = lastCommandData;
+            cmdPayloadLength[execHead & CMD_QUEUE_MASK] = respPayloadLength;
+            execHead++;
+        }
+        else if(samplerIsDue() && i2cIsIdle())
+        {
+            // Take the next sample frame between the commands, only if the host does not hold the bus.
+            i2cStartDeadline(I2C_TIMEOUT_BATCH);
+            samplerRun(servicePoll);
+        }
+
+        if(usbInterruptIsReady())
+        {
+            // Interrupt-IN endpoint is free, submit the next completion record.
+            if(rejectPending)
+            {
+                sendCompletionEvent(rejectRecord);
+                rejectPending = 0;
+            }
+            else if(eventHead != execHead)
+            {
+                sendCompletionEvent(cmdQueue[eventHead & CMD_QUEUE_MASK]);
+                eventHead++;
+            }
         }
         
         // Process USB messages received from the host.
-        usbPoll();
+        servicePoll();
     }
 
     return 0;
@@ -184,54 +282,153 @@ void initSystem()
 
     DDRA = 0x00;
     PORTA = 0x00;
+
+    // Start time base of the I2C bus timeouts.
+    i2cInitTimer();
     
     // Initialize global variables.
     lastCommandStatus = RET_SUCCESS;
     lastCommandData = 0x00;
     lastCommand = USB_CMD_NONE;
+
+    recvHead = 0;
+    execHead = 0;
+    eventHead = 0;
+    resultTail = 0;
+    rejectPending = 0;
+
+    reqSlot = 0;
+    reqPosition = 0;
+    reqRemaining = 0;
+    respPayload = cmdQueue[0];
+    respPayloadLength = 0;
+    respRecord = statusRecord;
+    respLength = 0;
+    respPosition = 0;
+    respDequeue = 0;
 }
 
-void clearRequestBuffer()
+void servicePoll()
 {
-    reqBuffer[0] = 0x00;
-    reqBuffer[1] = USB_CMD_NONE;
-    reqBuffer[2] = 0x00;
-    reqBuffer[3] = 0x00;
+    unsigned short currentTick = i2cTimerTick();
+
+    // Longest interval between the USB service calls, V-USB must be polled at least every 50ms.
+    if((unsigned short)(currentTick - statLastPoll) > statPollGap)
+    {
+        statPollGap = currentTick - statLastPoll;
+    }
+
+    statLastPoll = currentTick;
+    statUsbPolls++;
+    usbPoll();
+}
+
+void resetStatistics()
+{
+    unsigned char opPos;
+
+    for(opPos = 0; opPos < STATS_OPCODE_COUNT; opPos++)
+    {
+        statCommands[opPos] = 0;
+    }
+
+    statUsbPolls = 0;
+    statPollGap = 0;
+    statLastPoll = i2cTimerTick();
+    statRejected = 0;
+
+    i2cResetStatistics();
+}
+
+void dequeueResult()
+{
+    // Release the oldest completed slot, completion record of it is not required anymore.
+    if(eventHead == resultTail)
+    {
+        eventHead++;
+    }
+
+    resultTail++;
+}
+
+void sendCompletionEvent(const unsigned char *header)
+{
+    // Completion record format:
+    // SIGNATURE | COMMAND | STATUS | DATA | TAG | RESERVED
+    eventRecord[0] = header[0];
+    eventRecord[1] = header[1];
+    eventRecord[2] = header[2];
+    eventRecord[3] = header[3];
+    eventRecord[4] = header[4];
+    eventRecord[5] = 0x00;
+    eventRecord[6] = 0x00;
+    eventRecord[7] = 0x00;
+
+    usbSetInterrupt(eventRecord, USB_EVENT_RECORD_SIZE);
 }
 
 unsigned char usbFunctionRead(unsigned char *data, unsigned char len)
 {
+    unsigned char pos;
+
     // Response data format:
-    // SIGNATURE | COMMAND | STATUS | DATA | END SIGNATURE
-    data[0] = SYS_SIGNATURE;
-    data[1] = lastCommand;
-    data[2] = lastCommandStatus;
-    data[3] = lastCommandData;
-    data[4] = SYS_END_SIGNATURE;
-
-    return 4;
+    // SIGNATURE | COMMAND | STATUS | DATA | TAG | PAYLOAD (optional)
+    for(pos = 0; (pos < len) && (respPosition < respLength); pos++, respPosition++)
+    {
+        data[pos] = respRecord[respPosition];
+    }
+
+    if(respDequeue && (respPosition >= respLength))
+    {
+        // Completed result is delivered to the host, release the slot for the next request.
+        dequeueResult();
+        respDequeue = 0;
+    }
+
+    return pos;
 }
 
 unsigned char usbFunctionWrite(unsigned char *data, unsigned char len)
 {
+    unsigned char pos;
+
     // Received command format: 
-    // SIGNATURE | COMMAND | DATA BYTE | END SIGNATURE
-    if((len > 4)  && (data[0] == SYS_SIGNATURE))
+    // SIGNATURE | COMMAND | DATA BYTE | END SIGNATURE | TAG | PAYLOAD (optional)
+    if((reqPosition == 0) && (reqSlot == 0))
     {
-        // Reset last command variables.
-        lastCommandStatus = RET_PENDING;
-        lastCommandData = 0x00;
-        lastCommand = data[1];
-        
-        // Copy received data into request buffer.
-        reqBuffer[0] = data[0];
-        reqBuffer[1] = data[1];
-        reqBuffer[2] = data[2];
-        reqBuffer[3] = data[3];
+        // Command queue is full, keep the command and tag to report the rejection.
+        rejectRecord[0] = data[0];
+        rejectRecord[1] = (len > 1) ? data[1] : USB_CMD_NONE;
+        rejectRecord[2] = RET_QUEUE_FULL;
+        rejectRecord[3] = 0x00;
+        rejectRecord[4] = (len >= USB_REQ_HEADER_SIZE) ? data[4] : 0x00;
     }
     
-    // End of the data chunk.
-    return 1;
+    // Copy received data chunk into the queue slot, data of the rejected command is dropped.
+    for(pos = 0; (pos < len) && (reqRemaining > 0); pos++, reqRemaining--, reqPosition++)
+    {
+        if(reqSlot)
+        {
+            reqSlot[reqPosition] = data[pos];
+        }
+    }
+
+    if(reqRemaining == 0)
+    {
+        if(reqSlot == 0)
+        {
+            // Report the rejection to the host, host need to resend the command later.
+            rejectPending = ((rejectRecord[0] == SYS_SIGNATURE) && (rejectRecord[1] != USB_CMD_NONE));
+        }
+        else if((reqSlot[0] == SYS_SIGNATURE) && (reqSlot[1] != USB_CMD_NONE))
+        {
+            // Request is complete, pass it to the main loop for execution.
+            recvHead++;
+        }
+    }
+
+    // End of the data chunk if all the bytes are received.
+    return (reqRemaining == 0);
 }
 
 usbMsgLen_t usbFunctionSetup(unsigned char data[8])
@@ -244,11 +441,51 @@ usbMsgLen_t usbFunctionSetup(unsigned char data[8])
         if(request->bRequest == USBRQ_HID_GET_REPORT)
         {
             // use usbFunctionRead to obtain data.
+            respPosition = 0;
+            respDequeue = 0;
+
+            if(rejectPending)
+            {
+                // Rejected command is reported before the queued results.
+                respRecord = rejectRecord;
+                respLength = USB_RESP_HEADER_SIZE;
+                rejectPending = 0;
+            }
+            else if(resultTail != execHead)
+            {
+                // Return the oldest completed result and release it after the transfer.
+                respRecord = cmdQueue[resultTail & CMD_QUEUE_MASK];
+                respLength = USB_RESP_HEADER_SIZE + cmdPayloadLength[resultTail & CMD_QUEUE_MASK];
+                respDequeue = 1;
+            }
+            else
+            {
+                // No completed results, report the pending state of the next queued command.
+                statusRecord[0] = SYS_SIGNATURE;
+                statusRecord[1] = (execHead != recvHead) ? cmdQueue[execHead & CMD_QUEUE_MASK][1] : USB_CMD_NONE;
+                statusRecord[2] = RET_PENDING;
+                statusRecord[3] = 0x00;
+                statusRecord[4] = (execHead != recvHead) ? cmdQueue[execHead & CMD_QUEUE_MASK][4] : 0x00;
+                respRecord = statusRecord;
+                respLength = USB_RESP_HEADER_SIZE;
+            }
+
             return USB_NO_MSG;
         }
         else if(request->bRequest == USBRQ_HID_SET_REPORT)
         {
             // use usbFunctionWrite to receive data from host.
+            // Use the next free slot, or reject the command if all the slots are waiting for execution or collection.
+            // Uncollected results are never dropped, host drains the results of the previous session on open.
+            reqSlot = ((unsigned char)(recvHead - resultTail) < CMD_QUEUE_SIZE) ? cmdQueue[recvHead & CMD_QUEUE_MASK] : 0;
+            reqPosition = 0;
+            reqRemaining = (request->wLength.word > USB_REPORT_SIZE) ? USB_REPORT_SIZE : request->wLength.bytes[0];
+
+            if(reqSlot == 0)
+            {
+                statRejected++;
+            }
+
             return USB_NO_MSG;
         }        
     }
@@ -266,7 +503,7 @@ unsigned char setOutputVoltage(unsigned char voltage, unsigned char *newVoltage)
     // Wait to stable the output terminals.
     while(--countdown)
     {
-        usbPoll();
+        servicePoll();
         _delay_us(I2C_DELAY_DELTA);
     }
 
@@ -286,7 +523,8 @@ unsigned char resetI2CSlave(unsigned char voltage)
 {
     unsigned char countdown = 0x96;
     
-    // Shutdown both 3.3V and 5V output lines.
+    // Stop sampling and shutdown both 3.3V and 5V output lines.
+    samplerControl(0);
     PORTB &= 0xFC;
 
     // Reset all I2C registers to default values.
@@ -299,11 +537,277 @@ unsigned char resetI2CSlave(unsigned char voltage)
     // Wait to stable the output terminals.
     while(--countdown)
     {
-        usbPoll();
+        servicePoll();
         _delay_us(I2C_DELAY_DELTA);
     }
 
     // Restore voltage to the slave device.
     PORTB |= voltage;
     return RET_SUCCESS;
+}
+
+unsigned char execBatch(unsigned char opCount, unsigned char *ops)
+{
+    unsigned char opPos, opStatus, opData;
+    
+    if(opCount > BATCH_MAX_OPS)
+    {
+        // Number of operations exceeds the size of the request buffer.
+        return RET_UNKNOWN;
+    }
+
+    // Execute all the operations back-to-back. Operation format: COMMAND | DATA
+    for(opPos = 0; opPos < opCount; opPos++)
+    {
+        opData = 0x00;
+        
+        switch(ops[0])
+        {
+        case USB_CMD_I2C_START:
+            // Send I2C start or repeated start command.
+            opStatus = i2cStart(servicePoll);
+            break;
+        case USB_CMD_I2C_STOP:
+            // Send I2C stop command.
+            i2cStop();
+            opStatus = RET_SUCCESS;
+            break;
+        case USB_CMD_I2C_WRITE_ADDR:
+            // Send slave device address and read/write flag.
+            opStatus = i2cWriteAddr(servicePoll, ops[1]);
+            break;
+        case USB_CMD_I2C_WRITE:
+            // Write data byte into slave device.
+            opStatus = i2cWrite(servicePoll, ops[1]);
+            break;
+        case USB_CMD_I2C_READ:
+            // Read data byte with specified ACK status.
+            opStatus = i2cRead(servicePoll, ops[1], &opData);
+            break;
+        default:
+            // Unsupported operation inside the batch.
+            opStatus = RET_UNKNOWN;
+        }
+
+        // Store operation result in the response. Result format: STATUS | DATA
+        respPayload[respPayloadLength++] = opStatus;
+        respPayload[respPayloadLength++] = opData;
+        ops += 2;
+
+        if((opStatus == RET_TIMEOUT_FAIL) || (opStatus == RET_BUS_BUSY_FAIL) || (opStatus == RET_UNKNOWN))
+        {
+            // Abort the batch, rest of the operations depend on this result.
+            break;
+        }
+    }
+
+    // DATA0 of the response contains the number of executed operations.
+    lastCommandData = respPayloadLength / 2;
+    return (lastCommandData == opCount) ? RET_SUCCESS : opStatus;
+}
+
+unsigned char execReadRegister(unsigned char addr, unsigned char reg, unsigned char count)
+{
+    unsigned char status;
+    struct I2CMessage regMessages[2];
+
+    if((count == 0) || (count > (USB_REPORT_SIZE - USB_RESP_HEADER_SIZE)))
+    {
+        // Requested data does not fit into the response.
+        return RET_UNKNOWN;
+    }
+
+    // Select the register: START | SLA+W | REGISTER
+    regMessages[0].addr = (addr << 1);
+    regMessages[0].flags = 0;
+    regMessages[0].length = 1;
+    regMessages[0].data = &reg;
+
+    // Read register content: REPEATED START | SLA+R | DATA... | STOP
+    regMessages[1].addr = ((addr << 1) | 0x01);
+    regMessages[1].flags = 0;
+    regMessages[1].length = count;
+    regMessages[1].data = respPayload;
+
+    status = i2cTransfer(servicePoll, regMessages, 2);
+
+    // DATA0 of the response contains the number of received bytes.
+    respPayloadLength = regMessages[1].done;
+    lastCommandData = respPayloadLength;
+    return status;
+}
+
+unsigned char execWriteRegister(unsigned char addr, unsigned char reg, unsigned char count, unsigned char *data)
+{
+    unsigned char status;
+    struct I2CMessage regMessages[2];
+
+    if(count > (USB_REPORT_SIZE - USB_REQ_HEADER_SIZE - 2))
+    {
+        // Specified data length exceeds the size of the request buffer.
+        return RET_UNKNOWN;
+    }
+
+    // Select the register: START | SLA+W | REGISTER
+    regMessages[0].addr = (addr << 1);
+    regMessages[0].flags = 0;
+    regMessages[0].length = 1;
+    regMessages[0].data = &reg;
+
+    // Write register content without repeated START: DATA... | STOP
+    regMessages[1].addr = (addr << 1);
+    regMessages[1].flags = I2C_MSG_NO_START;
+    regMessages[1].length = count;
+    regMessages[1].data = data;
+
+    status = i2cTransfer(servicePoll, regMessages, 2);
+
+    // DATA0 of the response contains the number of acknowledged data bytes.
+    lastCommandData = regMessages[1].done;
+    return status;
+}
+
+unsigned char execScanBus()
+{
+    unsigned char addr, status, scanStatus;
+    unsigned char *bitmap = respPayload;
+    unsigned char *addrStatus = &respPayload[SCAN_BITMAP_SIZE];
+
+    // Response payload format: PRESENCE BITMAP | ADDRESS STATUS
+    for(respPayloadLength = 0; respPayloadLength < (SCAN_BITMAP_SIZE + SCAN_STATUS_SIZE); respPayloadLength++)
+    {
+        respPayload[respPayloadLength] = 0x00;
+    }
+
+    lastCommandData = 0;
+
+    for(addr = SCAN_FIRST_ADDR; addr <= SCAN_LAST_ADDR; addr++)
+    {
+        // Each probe is a single bus command with its own deadline.
+        i2cStartDeadline(I2C_TIMEOUT_COMMAND);
+        status = i2cProbe(servicePoll, addr);
+
+        switch(status)
+        {
+        case TW_MT_SLA_ACK:
+            // Slave device is available in the current address.
+            bitmap[addr >> 3] |= (1 << (addr & 0x07));
+            lastCommandData++;
+            scanStatus = SCAN_STATUS_ACK;
+            break;
+        case TW_MT_SLA_NACK:
+            // No slave device in the current address.
+            scanStatus = SCAN_STATUS_NONE;
+            break;
+        case RET_TIMEOUT_FAIL:
+            // Slave device holds the clock line for too long.
+            scanStatus = SCAN_STATUS_TIMEOUT;
+            break;
+        default:
+            // Bus is busy, arbitration lost or bus error.
+            scanStatus = SCAN_STATUS_ERROR;
+        }
+
+        // Four 2-bit status entries per byte, lowest address in the least significant bits.
+        addrStatus[addr >> 2] |= (scanStatus << ((addr & 0x03) * 2));
+
+        if(status == RET_BUS_BUSY_FAIL)
+        {
+            // Bus is held by another master or a stuck slave, rest of the probes cannot transmit START.
+            return RET_BUS_BUSY_FAIL;
+        }
+    }
+
+    // DATA0 of the response contains the number of slave devices found on the bus.
+    return RET_SUCCESS;
+}
+
+unsigned char execReadBulk(unsigned char count, unsigned char lastAck)
+{
+    unsigned char status;
+    struct I2CMessage readMessage;
+
+    if((count == 0) || (count > (USB_REPORT_SIZE - USB_RESP_HEADER_SIZE)))
+    {
+        // Requested data does not fit into the response.
+        return RET_UNKNOWN;
+    }
+
+    // Continue the read transaction started with START and SLA+R: DATA...
+    readMessage.addr = 0x01;
+    readMessage.flags = I2C_MSG_NO_START | I2C_MSG_NO_STOP | (lastAck ? I2C_MSG_LAST_ACK : 0);
+    readMessage.length = count;
+    readMessage.data = respPayload;
+
+    status = i2cTransfer(servicePoll, &readMessage, 1);
+
+    // DATA0 of the response contains the number of received bytes.
+    respPayloadLength = readMessage.done;
+    lastCommandData = respPayloadLength;
+    return status;
+}
+
+unsigned char execWriteBulk(unsigned char count, unsigned char *data)
+{
+    unsigned char status;
+    struct I2CMessage writeMessage;
+
+    if((count == 0) || (count > (USB_REPORT_SIZE - USB_REQ_HEADER_SIZE)))
+    {
+        // Specified data length exceeds the size of the request buffer.
+        return RET_UNKNOWN;
+    }
+
+    // Continue the write transaction started with START and SLA+W: DATA...
+    writeMessage.addr = 0x00;
+    writeMessage.flags = I2C_MSG_NO_START | I2C_MSG_NO_STOP;
+    writeMessage.length = count;
+    writeMessage.data = data;
+
+    status = i2cTransfer(servicePoll, &writeMessage, 1);
+
+    // DATA0 of the response contains the number of acknowledged bytes (index of the rejected byte).
+    lastCommandData = writeMessage.done;
+    return status;
+}
+
+static void putStatValue(unsigned long value, unsigned char size)
+{
+    // Counter values are sent LSB first.
+    while(size--)
+    {
+        respPayload[respPayloadLength++] = value & 0xFF;
+        value >>= 8;
+    }
+}
+
+unsigned char execGetStats(unsigned char reset)
+{
+    struct I2CStatistics busStats;
+    unsigned char opPos;
+
+    i2cGetStatistics(&busStats);
+
+    // Counter format: USB POLLS | WAIT ITERATIONS | MAX POLL GAP | TIMEOUTS | BUS BUSY | ARBITRATION LOST | REJECTED | COMMANDS...
+    putStatValue(statUsbPolls, 4);
+    putStatValue(busStats.waitIterations, 4);
+    putStatValue(statPollGap, 2);
+    putStatValue(busStats.timeouts, 2);
+    putStatValue(busStats.busBusy, 2);
+    putStatValue(busStats.arbitrationLost, 2);
+    putStatValue(statRejected, 2);
+
+    for(opPos = 0; opPos < STATS_OPCODE_COUNT; opPos++)
+    {
+        putStatValue(statCommands[opPos], 2);
+    }
+
+    if(reset)
+    {
+        resetStatistics();
+    }
+
+    // DATA0 of the response contains the number of command counters.
+    lastCommandData = STATS_OPCODE_COUNT;
+    return RET_SUCCESS;
 }
\ No newline at end of file
@@ -38,19 +38,112 @@
 #define USB_CMD_SET_VOLTAGE     0x07
 #define USB_CMD_GET_VOLTAGE     0x08
 #define USB_CMD_RESET           0x09
+#define USB_CMD_BATCH           0x0A
+#define USB_CMD_I2C_READ_REG    0x0B
+#define USB_CMD_I2C_WRITE_REG   0x0C
+#define USB_CMD_SET_TIMEOUT     0x0D
+#define USB_CMD_I2C_SCAN        0x0E
+#define USB_CMD_I2C_READ_BULK   0x0F
+#define USB_CMD_I2C_WRITE_BULK  0x10
+#define USB_CMD_SAMPLE_CONFIG   0x11
+#define USB_CMD_SAMPLE_CONTROL  0x12
+#define USB_CMD_SAMPLE_READ     0x13
+#define USB_CMD_GET_STATS       0x14
+
+// HID feature report size (ref: usbHidReportDescriptor - REPORT_COUNT).
+#define USB_REPORT_SIZE         128
+
+// Request header: SIGNATURE | COMMAND | DATA0 | END SIGNATURE | TAG
+// Response header: SIGNATURE | COMMAND | STATUS | DATA0 | TAG
+// TAG is selected by the host and echoed back to match the response with the request.
+#define USB_REQ_HEADER_SIZE     5
+#define USB_RESP_HEADER_SIZE    5
+
+// Completion record sent over the interrupt-IN endpoint: SIGNATURE | COMMAND | STATUS | DATA0 | TAG
+#define USB_EVENT_RECORD_SIZE   8
+
+// Each batch operation is a COMMAND | DATA pair in the request and a STATUS | DATA pair in the response.
+#define BATCH_MAX_OPS   ((USB_REPORT_SIZE - USB_REQ_HEADER_SIZE) / 2)
+
+// Bus scan covers the non-reserved 7-bit addresses. Response carries the presence bitmap and 
+// 2-bit status of each address (SCAN_STATUS_*) for the complete 0x00 - 0x7F address space.
+#define SCAN_FIRST_ADDR     0x08
+#define SCAN_LAST_ADDR      0x77
+#define SCAN_BITMAP_SIZE    16
+#define SCAN_STATUS_SIZE    32
+
+#define SCAN_STATUS_NONE    0x00    // NACK or address is not scanned.
+#define SCAN_STATUS_ACK     0x01    // Slave device acknowledged the address.
+#define SCAN_STATUS_TIMEOUT 0x02    // Slave device holds the clock line.
+#define SCAN_STATUS_ERROR   0x03    // Bus is busy, arbitration lost or bus error.
+
+// Command queue depth (must be a power of 2). Each slot receives a request and, once the command
+// is executed, the same slot is rewritten with the response until the host collects it.
+#define CMD_QUEUE_SIZE  4
+#define CMD_QUEUE_MASK  (CMD_QUEUE_SIZE - 1)
+
+// Performance counters returned by USB_CMD_GET_STATS, multi-byte values are LSB first:
+// USB POLLS (32) | WAIT ITERATIONS (32) | MAX POLL GAP (16) | TIMEOUTS (16) | BUS BUSY (16) | ARBITRATION LOST (16) |
+// REJECTED (16) | COMMAND COUNT (16) of each opcode from 0x01 to STATS_OPCODE_COUNT.
+// Poll gap is in Timer1 ticks (1024 / F_CPU). DATA0 of the response contains STATS_OPCODE_COUNT.
+#define STATS_OPCODE_COUNT  USB_CMD_GET_STATS
+#define STATS_HEADER_SIZE   18
+#define STATS_SIZE          (STATS_HEADER_SIZE + (STATS_OPCODE_COUNT * 2))
 
 #define I2C_OUTPUT_5V   0x01
 #define I2C_OUTPUT_3V3  0x02
 
-static unsigned char reqBuffer[4];
+// Free running queue indexes: slots in [resultTail, execHead) are completed, slots in 
+// [execHead, recvHead) are waiting for execution and eventHead follows the completion records.
+static unsigned char cmdQueue[CMD_QUEUE_SIZE][USB_REPORT_SIZE];
+static unsigned char cmdPayloadLength[CMD_QUEUE_SIZE];
+static unsigned char recvHead;
+static unsigned char execHead;
+static unsigned char eventHead;
+static unsigned char resultTail;
+
+static unsigned char *reqSlot;
+static unsigned char reqPosition;
+static unsigned char reqRemaining;
+
+static unsigned char *respPayload;
+static unsigned char respPayloadLength;
+
+static unsigned char *respRecord;
+static unsigned char respLength;
+static unsigned char respPosition;
+static unsigned char respDequeue;
+
+static unsigned char statusRecord[USB_RESP_HEADER_SIZE];
+static unsigned char rejectRecord[USB_RESP_HEADER_SIZE];
+static unsigned char rejectPending;
 
 static unsigned char lastCommandStatus;
 static unsigned char lastCommandData;
 static unsigned char lastCommand;
 
+static unsigned char eventRecord[USB_EVENT_RECORD_SIZE];
+
+// Performance counters, cleared on request of the host.
+static unsigned short statCommands[STATS_OPCODE_COUNT];
+static unsigned long statUsbPolls;
+static unsigned short statPollGap;
+static unsigned short statLastPoll;
+static unsigned short statRejected;
+
 void initSystem();
-void clearRequestBuffer();
+void servicePoll();
+void resetStatistics();
+void dequeueResult();
 unsigned char setOutputVoltage(unsigned char voltage, unsigned char *newVoltage);
 unsigned char resetI2CSlave(unsigned char voltage);
+void sendCompletionEvent(const unsigned char *header);
+unsigned char execBatch(unsigned char opCount, unsigned char *ops);
+unsigned char execReadRegister(unsigned char addr, unsigned char reg, unsigned char count);
+unsigned char execWriteRegister(unsigned char addr, unsigned char reg, unsigned char count, unsigned char *data);
+unsigned char execScanBus();
+unsigned char execReadBulk(unsigned char count, unsigned char lastAck);
+unsigned char execWriteBulk(unsigned char count, unsigned char *data);
+unsigned char execGetStats(unsigned char reset);
 
 #endif /* I2C_TESTER_MAIN_HEADER */
\ No newline at end of file
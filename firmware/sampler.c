@@ -0,0 +1,236 @@
+//----------------------------------------------------------------------------------
+// I2C Test Terminal Firmware - Register Sampling Engine.
+//
+// Copyright (c) 2021 Dilshan R Jayakody [jayakody2000lk@gmail.com].
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//----------------------------------------------------------------------------------
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/twi.h>
+
+#include "sampler.h"
+#include "i2cdrv.h"
+
+static struct SampleEntry sampleEntries[SAMPLE_MAX_ENTRIES];
+static unsigned char sampleEntryCount = 0;
+static unsigned char sampleFrameSize = 0;
+static unsigned short samplePeriod = 0;
+
+// Ring of complete frames, each frame is stored contiguously in its own slot.
+static unsigned char sampleRing[SAMPLE_RING_SIZE];
+static unsigned char sampleSlotCount = 0;
+static unsigned char sampleHead = 0;
+static unsigned char sampleTail = 0;
+static unsigned char sampleFrames = 0;
+static unsigned char sampleSequence = 0;
+
+// Sampling ticks which are not served by the main loop and frames dropped due to the full ring.
+static volatile unsigned char sampleMissed = 0;
+static unsigned char sampleDropped = 0;
+
+static volatile unsigned short sampleCountdown = 0;
+static volatile unsigned char sampleDue = 0;
+
+ISR(TIMER2_COMP_vect, ISR_NOBLOCK)
+{
+    // 1ms tick, V-USB interrupt is allowed while counting down the sampling period.
+    if(--sampleCountdown == 0)
+    {
+        sampleCountdown = samplePeriod;
+
+        if(sampleDue && (sampleMissed < 0xFF))
+        {
+            // Previous sample is not taken yet.
+            sampleMissed++;
+        }
+
+        sampleDue = 1;
+    }
+}
+
+unsigned char samplerConfigure(unsigned char count, const unsigned char *config)
+{
+    unsigned char entryPos, frameSize;
+    unsigned short period;
+
+    // Reconfiguration stops the sampling and drops the buffered frames.
+    samplerControl(0);
+    sampleEntryCount = 0;
+    sampleSlotCount = 0;
+
+    period = config[0] | (config[1] << 8);
+    if((count == 0) || (count > SAMPLE_MAX_ENTRIES) || (period == 0) || (period > SAMPLE_MAX_PERIOD_MS))
+    {
+        // Empty sampling list or the period is out of range.
+        return RET_UNKNOWN;
+    }
+
+    config += SAMPLE_CONFIG_HEADER;
+    frameSize = SAMPLE_FRAME_HEADER;
+
+    for(entryPos = 0; entryPos < count; entryPos++, config += SAMPLE_ENTRY_SIZE)
+    {
+        if((config[2] == 0) || ((frameSize + config[2]) > SAMPLE_MAX_FRAME))
+        {
+            // Sample frame does not fit into a ring slot.
+            return RET_UNKNOWN;
+        }
+
+        sampleEntries[entryPos].addr = config[0];
+        sampleEntries[entryPos].reg = config[1];
+        sampleEntries[entryPos].length = config[2];
+        frameSize += config[2];
+    }
+
+    sampleEntryCount = count;
+    sampleFrameSize = frameSize;
+    sampleSlotCount = SAMPLE_RING_SIZE / frameSize;
+    samplePeriod = period;
+
+    return RET_SUCCESS;
+}
+
+unsigned char samplerControl(unsigned char enable)
+{
+    // Stop the time base and reset the state of the ring.
+    TIMSK &= ~(1 << OCIE2);
+    TCCR2 = 0x00;
+
+    sampleHead = 0;
+    sampleTail = 0;
+    sampleFrames = 0;
+    sampleSequence = 0;
+    sampleMissed = 0;
+    sampleDropped = 0;
+    sampleDue = 0;
+
+    if(!enable)
+    {
+        return RET_SUCCESS;
+    }
+
+    if(sampleEntryCount == 0)
+    {
+        // Sampling list is not configured.
+        return RET_UNKNOWN;
+    }
+
+    // Timer2 in CTC mode with 128 prescaler generates the 1ms tick.
+    sampleCountdown = samplePeriod;
+    TCNT2 = 0;
+    OCR2 = SAMPLE_TIMER_COMPARE;
+    TCCR2 = (1 << WGM21) | (1 << CS22) | (1 << CS20);
+    TIFR = (1 << OCF2);
+    TIMSK |= (1 << OCIE2);
+
+    return RET_SUCCESS;
+}
+
+unsigned char samplerIsDue()
+{
+    return sampleDue;
+}
+
+void samplerRun(void (*usbProc)(void))
+{
+    unsigned char entryPos, status;
+    unsigned char *frame;
+    struct I2CMessage regMessages[2];
+
+    sampleDue = 0;
+    if(sampleFrames >= sampleSlotCount)
+    {
+        // Ring is full, host is not draining the frames fast enough.
+        if(sampleDropped < 0xFF)
+        {
+            sampleDropped++;
+        }
+
+        return;
+    }
+
+    // Frame format: SEQUENCE | STATUS | DATA OF EACH ENTRY
+    frame = &sampleRing[sampleHead * sampleFrameSize];
+    frame[0] = sampleSequence++;
+    frame[1] = RET_SUCCESS;
+
+    regMessages[0].flags = 0;
+    regMessages[0].length = 1;
+    regMessages[1].flags = 0;
+    regMessages[1].data = &frame[SAMPLE_FRAME_HEADER];
+
+    for(entryPos = 0; entryPos < sampleEntryCount; entryPos++)
+    {
+        // Register read: START | SLA+W | REGISTER | REPEATED START | SLA+R | DATA... | STOP
+        regMessages[0].addr = (sampleEntries[entryPos].addr << 1);
+        regMessages[0].data = &sampleEntries[entryPos].reg;
+        regMessages[1].addr = ((sampleEntries[entryPos].addr << 1) | 0x01);
+        regMessages[1].length = sampleEntries[entryPos].length;
+
+        // Transfer returns the TWI status of the last step, a successful read ends with a received data byte.
+        status = i2cTransfer(usbProc, regMessages, 2);
+        if((status != TW_MR_DATA_NACK) && (status != TW_MR_DATA_ACK) && (frame[1] == RET_SUCCESS))
+        {
+            // Keep the status of the first failing read, rest of the entries are still sampled.
+            frame[1] = status;
+        }
+
+        regMessages[1].data += sampleEntries[entryPos].length;
+    }
+
+    sampleHead = ((sampleHead + 1) >= sampleSlotCount) ? 0 : (sampleHead + 1);
+    sampleFrames++;
+}
+
+unsigned char samplerRead(unsigned char *data, unsigned char maxLength, unsigned char *frameCount)
+{
+    unsigned char length, pos, missed;
+    unsigned char sreg = SREG;
+    unsigned char *frame;
+
+    // Missed tick counter is also updated by the Timer2 interrupt.
+    cli();
+    missed = sampleMissed;
+    sampleMissed = 0;
+    SREG = sreg;
+
+    // Block format: MISSED | FRAME SIZE | FRAMES...
+    data[0] = ((missed + sampleDropped) > 0xFF) ? 0xFF : (missed + sampleDropped);
+    data[1] = sampleFrameSize;
+    sampleDropped = 0;
+    length = 2;
+    *frameCount = 0;
+
+    while((sampleFrames > 0) && ((length + sampleFrameSize) <= maxLength))
+    {
+        frame = &sampleRing[sampleTail * sampleFrameSize];
+        for(pos = 0; pos < sampleFrameSize; pos++)
+        {
+            data[length++] = frame[pos];
+        }
+
+        sampleTail = ((sampleTail + 1) >= sampleSlotCount) ? 0 : (sampleTail + 1);
+        sampleFrames--;
+        (*frameCount)++;
+    }
+
+    return length;
+}
\ No newline at end of file
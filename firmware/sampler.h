@@ -0,0 +1,55 @@
+//----------------------------------------------------------------------------------
+// I2C Test Terminal Firmware - Register Sampling Engine.
+//
+// Copyright (c) 2021 Dilshan R Jayakody [jayakody2000lk@gmail.com].
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//----------------------------------------------------------------------------------
+
+#ifndef I2C_SAMPLER_HEADER
+#define I2C_SAMPLER_HEADER
+
+// Sampling list and the RAM ring of the sample frames.
+#define SAMPLE_MAX_ENTRIES  8
+#define SAMPLE_RING_SIZE    96
+#define SAMPLE_FRAME_HEADER 2       // SEQUENCE | STATUS
+#define SAMPLE_MAX_FRAME    32
+
+// Sampling configuration: PERIOD (LSB) | PERIOD (MSB) | ADDRESS | REGISTER | LENGTH | ... 
+#define SAMPLE_CONFIG_HEADER    2
+#define SAMPLE_ENTRY_SIZE       3
+#define SAMPLE_MAX_PERIOD_MS    60000
+
+// Timer2 in CTC mode with 128 prescaler, compare match in every 1ms at 16MHz.
+#define SAMPLE_TIMER_COMPARE    ((unsigned char)((F_CPU / 128UL / 1000UL) - 1))
+
+struct SampleEntry
+{
+    unsigned char addr;     // 7-bit slave address.
+    unsigned char reg;
+    unsigned char length;
+};
+
+unsigned char samplerConfigure(unsigned char count, const unsigned char *config);
+unsigned char samplerControl(unsigned char enable);
+unsigned char samplerIsDue();
+void samplerRun(void (*usbProc)(void));
+unsigned char samplerRead(unsigned char *data, unsigned char maxLength, unsigned char *frameCount);
+
+#endif /* I2C_SAMPLER_HEADER */
\ No newline at end of file
@@ -0,0 +1,377 @@
+//----------------------------------------------------------------------------------
+// I2C Test Terminal - Benchmark Suite.
+//
+// Copyright (c) 2021 Dilshan R Jayakody [jayakody2000lk@gmail.com].
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//----------------------------------------------------------------------------------
+
+#include "bench.h"
+#include "termutil.h"
+#include "strdef.h"
+
+#include <getopt.h>
+#include <errno.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+static const struct option benchOptions[] = 
+{
+    {"device", required_argument, NULL, 'd'},
+    {"serial", required_argument, NULL, 's'},
+    {"simulate", optional_argument, NULL, 'm'},
+    {"poll", required_argument, NULL, 'P'},
+    {"iterations", required_argument, NULL, 'n'},
+    {"address", required_argument, NULL, 'a'},
+    {"length", required_argument, NULL, 'b'},
+    {"speed", required_argument, NULL, 'k'},
+    {"commands", required_argument, NULL, 'c'},
+    {"throughput", required_argument, NULL, 't'},
+    {"offset", required_argument, NULL, 'O'},
+    {"page", required_argument, NULL, 'p'},
+    {"addr-bytes", required_argument, NULL, 'w'},
+    {"read-only", no_argument, NULL, 'R'},
+    {"csv", required_argument, NULL, 'o'},
+    {"help", no_argument, NULL, 'h'},
+    {NULL, 0, NULL, 0}
+};
+
+static const char *benchPollModes[] = {"immediate", "spin", "backoff", "event"};
+
+EXEC_STATUS openBenchTarget(struct BenchTarget *target, const char *transportName, const char *deviceTarget)
+{
+    unsigned char request[USB_SET_COMMAND_BUFFER_SIZE];
+    unsigned char response[USB_GET_DATA_BUFFER_SIZE];
+    uint64_t latencyNs;
+
+    if(openTransport(&target->transport, transportName, deviceTarget) == EXEC_FAIL)
+    {
+        printCommandError((strcmp(transportName, TRANSPORT_SIM) == 0) ? SIM_SLAVES_INVALID : DEV_NOT_OPEN, deviceTarget);
+        return EXEC_FAIL;
+    }
+
+    // Requests are executed through the device I/O worker, as same as the terminal session.
+    if(startDevWorker(&target->worker, &target->transport, 0) == EXEC_FAIL)
+    {
+        printErrorMsg(DEV_WORKER_FAIL);
+        closeTransport(&target->transport);
+        return EXEC_FAIL;
+    }
+
+    // Select the bus speed and keep the output voltage for the set-voltage case.
+    setUSBBuffer(request, USB_CMD_I2C_INIT, target->comSpeed);
+    if((execBenchRequest(target, request, response, &latencyNs, NULL) == EXEC_FAIL) || isBenchFailure(response))
+    {
+        printErrorMsg(DEV_COM_FAIL);
+        closeBenchTarget(target);
+        return EXEC_FAIL;
+    }
+
+    setUSBBuffer(request, USB_CMD_GET_VOLTAGE, 0x00);
+    if((execBenchRequest(target, request, response, &latencyNs, NULL) == EXEC_FAIL) || isBenchFailure(response))
+    {
+        printErrorMsg(DEV_COM_OUTPUT_VOLTAGE_FAIL);
+        closeBenchTarget(target);
+        return EXEC_FAIL;
+    }
+
+    target->outputVoltage = response[4];
+    return EXEC_SUCCESS;
+}
+
+void closeBenchTarget(struct BenchTarget *target)
+{
+    stopDevWorker(&target->worker);
+    closeTransport(&target->transport);
+}
+
+EXEC_STATUS execBenchRequest(struct BenchTarget *target, const unsigned char *request, unsigned char *response, uint64_t *latencyNs, unsigned int *pollCount)
+{
+    struct DevRequest devRequest, *result;
+    uint64_t startTime;
+
+    devRequest.request = request;
+    devRequest.response = response;
+    devRequest.callback = NULL;
+    devRequest.context = NULL;
+
+    // Round-trip time is measured on the caller, including the hand-off to the worker thread.
+    startTime = getCaptureClock();
+    if(submitDevRequest(&target->worker, &devRequest, 1) == EXEC_FAIL)
+    {
+        return EXEC_FAIL;
+    }
+
+    result = getDevResult(&target->worker, 1);
+    *latencyNs = getCaptureClock() - startTime;
+
+    if(pollCount != NULL)
+    {
+        *pollCount = (result != NULL) ? result->pollCount : 0;
+    }
+
+    return (result != NULL) ? result->status : EXEC_FAIL;
+}
+
+unsigned char isBenchFailure(const unsigned char *response)
+{
+    // Bus level status codes (ACK / NACK) are valid results of the measured commands.
+    switch(response[3])
+    {
+    case RET_UNKNOWN:
+    case RET_QUEUE_FULL:
+    case RET_BUS_BUSY_FAIL:
+    case RET_TIMEOUT_FAIL:
+        return 1;
+    }
+
+    return 0;
+}
+
+static EXEC_STATUS getBenchOption(const char *value, long minValue, long maxValue, long *option)
+{
+    char *endPos;
+
+    // Decimal and hexadecimal (0x) values are accepted.
+    errno = 0;
+    *option = strtol(value, &endPos, 0);
+
+    if((errno != 0) || (endPos == value) || (*endPos != 0) || (*option < minValue) || (*option > maxValue))
+    {
+        printCommandError(BENCH_PARAM_INVALID, value);
+        return EXEC_FAIL;
+    }
+
+    return EXEC_SUCCESS;
+}
+
+static EXEC_STATUS getBenchSpeed(const char *value, unsigned char *comSpeed)
+{
+    if(strcmp(value, "100") == 0)
+    {
+        *comSpeed = TWI_COM_SPEED_100;
+    }
+    else if(strcmp(value, "250") == 0)
+    {
+        *comSpeed = TWI_COM_SPEED_250;
+    }
+    else if(strcmp(value, "400") == 0)
+    {
+        *comSpeed = TWI_COM_SPEED_400;
+    }
+    else
+    {
+        printErrorMsg(CMD_MSG_SPEED_UNSUPPORT);
+        return EXEC_FAIL;
+    }
+
+    return EXEC_SUCCESS;
+}
+
+static EXEC_STATUS getBenchPollMode(const char *value)
+{
+    unsigned char modePos;
+
+    for(modePos = 0; modePos < (sizeof(benchPollModes) / sizeof(benchPollModes[0])); modePos++)
+    {
+        if(strcmp(value, benchPollModes[modePos]) == 0)
+        {
+            setPollMode(modePos);
+            return EXEC_SUCCESS;
+        }
+    }
+
+    printErrorMsg(CMD_PARAM_INVALID_POLL);
+    return EXEC_FAIL;
+}
+
+int main(int argc, char *argv[])
+{
+    struct BenchTarget target;
+    struct BenchRegion region;
+    struct TermDeviceInfo devInfo;
+    const char *transportName = TRANSPORT_HIDRAW;
+    const char *deviceTarget = NULL;
+    const char *serialNumber = NULL;
+    const char *caseList = NULL;
+    const char *csvPath = NULL;
+    unsigned int iterations = BENCH_DEFAULT_ITERATIONS;
+    unsigned int infoCount = 0;
+    FILE *csvFile = NULL;
+    EXEC_STATUS status;
+    long optionValue;
+    int option;
+
+    memset(&target, 0, sizeof(target));
+    target.address = BENCH_DEFAULT_ADDRESS;
+    target.length = BENCH_DEFAULT_LENGTH;
+    target.comSpeed = TWI_COM_SPEED_100;
+
+    memset(&region, 0, sizeof(region));
+    region.pageSize = BENCH_DEFAULT_PAGE_SIZE;
+    region.addrBytes = BENCH_DEFAULT_ADDR_BYTES;
+
+    while((option = getopt_long(argc, argv, "d:s:m::P:n:a:b:k:c:t:O:p:w:Ro:h", benchOptions, NULL)) != -1)
+    {
+        switch(option)
+        {
+        case 'd':
+            transportName = TRANSPORT_HIDRAW;
+            deviceTarget = optarg;
+            break;
+        case 's':
+            serialNumber = optarg;
+            break;
+        case 'm':
+            // Device simulator with the specified virtual slaves.
+            transportName = TRANSPORT_SIM;
+            deviceTarget = (optarg != NULL) ? optarg : SIM_DEFAULT_SLAVES;
+            break;
+        case 'P':
+            if(getBenchPollMode(optarg) == EXEC_FAIL)
+            {
+                return 1;
+            }
+            break;
+        case 'n':
+            if(getBenchOption(optarg, 1, 1000000, &optionValue) == EXEC_FAIL)
+            {
+                return 1;
+            }
+
+            iterations = optionValue;
+            break;
+        case 'a':
+            if(getBenchOption(optarg, 0x00, 0x7F, &optionValue) == EXEC_FAIL)
+            {
+                return 1;
+            }
+
+            target.address = optionValue;
+            break;
+        case 'b':
+            if(getBenchOption(optarg, 1, BULK_MAX_READ_COUNT, &optionValue) == EXEC_FAIL)
+            {
+                return 1;
+            }
+
+            target.length = optionValue;
+            break;
+        case 'k':
+            if(getBenchSpeed(optarg, &target.comSpeed) == EXEC_FAIL)
+            {
+                return 1;
+            }
+            break;
+        case 'c':
+            caseList = optarg;
+            break;
+        case 't':
+            // Size of the memory region used by the throughput benchmark.
+            if(getBenchOption(optarg, 1, 0x10000, &optionValue) == EXEC_FAIL)
+            {
+                return 1;
+            }
+
+            region.length = optionValue;
+            break;
+        case 'O':
+            if(getBenchOption(optarg, 0, 0xFFFF, &optionValue) == EXEC_FAIL)
+            {
+                return 1;
+            }
+
+            region.offset = optionValue;
+            break;
+        case 'p':
+            if(getBenchOption(optarg, 1, 256, &optionValue) == EXEC_FAIL)
+            {
+                return 1;
+            }
+
+            region.pageSize = optionValue;
+            break;
+        case 'w':
+            if(getBenchOption(optarg, 1, 2, &optionValue) == EXEC_FAIL)
+            {
+                return 1;
+            }
+
+            region.addrBytes = optionValue;
+            break;
+        case 'R':
+            // Content of the slave is not modified, only the read paths are measured.
+            region.readOnly = 1;
+            break;
+        case 'o':
+            csvPath = optarg;
+            break;
+        default:
+            printf(BENCH_MSG_USAGE, argv[0]);
+            return (option == 'h') ? 0 : 1;
+        }
+    }
+
+    if((region.length > 0) && ((region.offset + region.length) > ((region.addrBytes == 1) ? 0x800 : 0x10000)))
+    {
+        // 1-byte address covers 8 blocks of 256 bytes (24C16), 2-byte address covers 64KB (24C512).
+        printErrorMsg(BENCH_REGION_INVALID);
+        return 1;
+    }
+
+    if(deviceTarget == NULL)
+    {
+        // Find the I2C terminal device (USB device or the UHID emulator) on udev.
+        if(findTerminalDevices(serialNumber, &devInfo, 1, &infoCount) == EXEC_FAIL)
+        {
+            printErrorMsg(DEV_NOT_AVAILABLE);
+            return 1;
+        }
+
+        deviceTarget = devInfo.hidRawPath;
+    }
+
+    if(csvPath != NULL)
+    {
+        csvFile = (strcmp(csvPath, "-") == 0) ? stdout : fopen(csvPath, "w");
+        if(csvFile == NULL)
+        {
+            printCommandError(BENCH_CSV_NOT_OPEN, csvPath);
+            releaseTerminalDevices(&devInfo, infoCount);
+            return 1;
+        }
+    }
+
+    status = openBenchTarget(&target, transportName, deviceTarget);
+    if(status == EXEC_SUCCESS)
+    {
+        printf(BENCH_MSG_TARGET, transportName, deviceTarget, iterations, benchPollModes[getPollMode()]);
+        status = (region.length > 0) ? runThroughputSuite(&target, &region, csvFile) : runLatencySuite(&target, caseList, iterations, csvFile);
+        closeBenchTarget(&target);
+    }
+
+    if((csvFile != NULL) && (csvFile != stdout))
+    {
+        fclose(csvFile);
+    }
+
+    releaseTerminalDevices(&devInfo, infoCount);
+    return (status == EXEC_SUCCESS) ? 0 : 1;
+}
\ No newline at end of file
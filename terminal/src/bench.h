@@ -0,0 +1,135 @@
+//----------------------------------------------------------------------------------
+// I2C Test Terminal - Benchmark Suite.
+//
+// Copyright (c) 2021 Dilshan R Jayakody [jayakody2000lk@gmail.com].
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//----------------------------------------------------------------------------------
+
+#ifndef I2C_TERMINAL_BENCHMARK
+#define I2C_TERMINAL_BENCHMARK
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "i2cterm.h"
+
+#define BENCH_DEFAULT_ITERATIONS    100
+#define BENCH_DEFAULT_ADDRESS       0x50
+#define BENCH_DEFAULT_LENGTH        16
+
+// Stretch timeout used by the set-timeout case (ref: I2C_DEFAULT_STRETCH_TIMEOUT in firmware).
+#define BENCH_STRETCH_TIMEOUT       25
+
+// Sampling period used by the sample-config case, long enough to keep the bus free during the benchmark.
+#define BENCH_SAMPLE_PERIOD_MS      1000
+
+// Bus conditions required by the measured command, setup and cleanup requests are not timed.
+#define BENCH_PRE_START     0x01    // START before the command.
+#define BENCH_PRE_SLA_W     0x02    // START and SLA+W before the command.
+#define BENCH_PRE_SLA_R     0x04    // START and SLA+R before the command.
+#define BENCH_POST_STOP     0x08    // STOP after the command.
+#define BENCH_EXPLICIT      0x10    // Disturbs the slaves, executed only if listed by the user.
+#define BENCH_PIPELINED     0x20    // Requests are submitted ahead of the results, without any bus setup.
+
+#define BENCH_PRE_MASK      (BENCH_PRE_START | BENCH_PRE_SLA_W | BENCH_PRE_SLA_R)
+
+// Requests outstanding in the pipelined cases, twice the device slots to keep the worker supplied.
+#define BENCH_PIPELINE_DEPTH    (DEV_QUEUE_SIZE * 2)
+
+// Default EEPROM geometry of the throughput benchmark (24C02, smallest page of the 24Cxx family).
+#define BENCH_DEFAULT_PAGE_SIZE     8
+#define BENCH_DEFAULT_ADDR_BYTES    1
+
+// Address probes sent after a page write while the EEPROM is in the internal write cycle.
+#define BENCH_ACK_POLL_LIMIT        200
+
+// Transfer paths of the throughput benchmark.
+#define BENCH_XFER_PRIMITIVE    0   // START, WRITE-ADDRESS, WRITE / READ and STOP requests for each byte.
+#define BENCH_XFER_REGISTER     1   // Register read / write commands.
+#define BENCH_XFER_BULK         2   // Bulk read / write commands.
+#define BENCH_XFER_PATHS        3
+
+// Benchmark device opened over one of the transport backends.
+struct BenchTarget
+{
+    struct Transport transport;
+    struct DevWorker worker;
+    unsigned char address;          // 7-bit address of the slave used by the bus commands.
+    unsigned char length;           // Number of data bytes of the register and bulk commands.
+    unsigned char comSpeed;
+    unsigned char outputVoltage;
+};
+
+struct BenchCase
+{
+    const char *name;
+    unsigned char command;
+    unsigned char flags;
+};
+
+struct BenchResult
+{
+    const struct BenchCase *benchCase;
+    unsigned int iterations;
+    unsigned int errors;
+    uint64_t minNs;
+    uint64_t p50Ns;
+    uint64_t p99Ns;
+    uint64_t maxNs;
+    double averagePolls;
+    unsigned int maxPolls;
+};
+
+// Memory region of the EEPROM-like slave used by the throughput benchmark.
+struct BenchRegion
+{
+    unsigned int offset;
+    unsigned int length;
+    unsigned int pageSize;
+    unsigned char addrBytes;        // 1 (24C01 - 24C16, block in the slave address) or 2 (24C32 and above).
+    unsigned char readOnly;
+};
+
+struct BenchXferResult
+{
+    unsigned char path;
+    unsigned char write;
+    unsigned int length;
+    unsigned int errors;            // Failed chunks and mismatched bytes.
+    unsigned long requests;
+    unsigned long polls;
+    unsigned long ackPolls;
+    unsigned long transfers;        // USB transfers reported by the transport, each counted once.
+    uint64_t busCycles;             // SCL cycles of the issued bus operations.
+    uint64_t elapsedNs;
+};
+
+EXEC_STATUS openBenchTarget(struct BenchTarget *target, const char *transportName, const char *deviceTarget);
+void closeBenchTarget(struct BenchTarget *target);
+EXEC_STATUS execBenchRequest(struct BenchTarget *target, const unsigned char *request, unsigned char *response, uint64_t *latencyNs, unsigned int *pollCount);
+unsigned char isBenchFailure(const unsigned char *response);
+
+const struct BenchCase *findBenchCase(const char *name);
+EXEC_STATUS runLatencyCase(struct BenchTarget *target, const struct BenchCase *benchCase, unsigned int iterations, struct BenchResult *result);
+EXEC_STATUS runLatencySuite(struct BenchTarget *target, const char *caseList, unsigned int iterations, FILE *csvFile);
+
+EXEC_STATUS runThroughputSuite(struct BenchTarget *target, const struct BenchRegion *region, FILE *csvFile);
+
+#endif /* I2C_TERMINAL_BENCHMARK */
\ No newline at end of file
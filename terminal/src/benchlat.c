@@ -0,0 +1,391 @@
+//----------------------------------------------------------------------------------
+// I2C Test Terminal - Command Latency Benchmark.
+//
+// Copyright (c) 2021 Dilshan R Jayakody [jayakody2000lk@gmail.com].
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//----------------------------------------------------------------------------------
+
+#include "bench.h"
+#include "termutil.h"
+#include "strdef.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Command types measured by the latency suite, in the execution order.
+static const struct BenchCase benchCases[] =
+{
+    {"init", USB_CMD_I2C_INIT, 0},
+    {"start", USB_CMD_I2C_START, BENCH_POST_STOP},
+    {"stop", USB_CMD_I2C_STOP, BENCH_PRE_START},
+    {"write-addr", USB_CMD_I2C_WRITE_ADDR, BENCH_PRE_START | BENCH_POST_STOP},
+    {"write", USB_CMD_I2C_WRITE, BENCH_PRE_SLA_W | BENCH_POST_STOP},
+    {"read", USB_CMD_I2C_READ, BENCH_PRE_SLA_R | BENCH_POST_STOP},
+    {"get-voltage", USB_CMD_GET_VOLTAGE, 0},
+    {"set-voltage", USB_CMD_SET_VOLTAGE, BENCH_EXPLICIT},
+    {"reset", USB_CMD_RESET, BENCH_EXPLICIT},
+    {"batch", USB_CMD_BATCH, 0},
+    {"read-reg", USB_CMD_I2C_READ_REG, 0},
+    {"read-reg-queued", USB_CMD_I2C_READ_REG, BENCH_PIPELINED},
+    {"write-reg", USB_CMD_I2C_WRITE_REG, 0},
+    {"set-timeout", USB_CMD_SET_TIMEOUT, 0},
+    {"scan", USB_CMD_I2C_SCAN, 0},
+    {"read-bulk", USB_CMD_I2C_READ_BULK, BENCH_PRE_SLA_R | BENCH_POST_STOP},
+    {"write-bulk", USB_CMD_I2C_WRITE_BULK, BENCH_PRE_SLA_W | BENCH_POST_STOP},
+    {"sample-config", USB_CMD_SAMPLE_CONFIG, 0},
+    {"sample-control", USB_CMD_SAMPLE_CONTROL, 0},
+    {"sample-read", USB_CMD_SAMPLE_READ, 0},
+    {"get-stats", USB_CMD_GET_STATS, 0},
+    {NULL, USB_CMD_NONE, 0}
+};
+
+const struct BenchCase *findBenchCase(const char *name)
+{
+    const struct BenchCase *benchCase;
+
+    for(benchCase = benchCases; benchCase->name != NULL; benchCase++)
+    {
+        if(strcmp(benchCase->name, name) == 0)
+        {
+            return benchCase;
+        }
+    }
+
+    return NULL;
+}
+
+static void buildBenchRequest(struct BenchTarget *target, const struct BenchCase *benchCase, unsigned char *request)
+{
+    unsigned char *args = &request[USB_REQ_HEADER_SIZE];
+
+    // Arguments are selected to keep the content of the slave unchanged.
+    setUSBBuffer(request, benchCase->command, 0x00);
+
+    switch(benchCase->command)
+    {
+    case USB_CMD_I2C_INIT:
+        request[2] = target->comSpeed;
+        break;
+    case USB_CMD_I2C_WRITE_ADDR:
+        request[2] = (target->address << 1);
+        break;
+    case USB_CMD_SET_VOLTAGE:
+        request[2] = target->outputVoltage;
+        break;
+    case USB_CMD_BATCH:
+        // Address probe: START | SLA+W | STOP.
+        request[2] = 3;
+        args[0] = USB_CMD_I2C_START;
+        args[2] = USB_CMD_I2C_WRITE_ADDR;
+        args[3] = (target->address << 1);
+        args[4] = USB_CMD_I2C_STOP;
+        break;
+    case USB_CMD_I2C_READ_REG:
+        request[2] = target->address;
+        args[1] = target->length;
+        break;
+    case USB_CMD_I2C_WRITE_REG:
+        // Register pointer is written without any data bytes.
+        request[2] = target->address;
+        break;
+    case USB_CMD_SET_TIMEOUT:
+        request[2] = I2C_TIMEOUT_STRETCH;
+        args[0] = BENCH_STRETCH_TIMEOUT & 0xFF;
+        args[1] = BENCH_STRETCH_TIMEOUT >> 8;
+        break;
+    case USB_CMD_I2C_READ_BULK:
+        request[2] = target->length;
+        break;
+    case USB_CMD_I2C_WRITE_BULK:
+        // Only the register pointer (first byte of the write transaction) is sent.
+        request[2] = 1;
+        break;
+    case USB_CMD_SAMPLE_CONFIG:
+        // Single sampling entry, sampling is not started by the benchmark.
+        request[2] = 1;
+        args[0] = BENCH_SAMPLE_PERIOD_MS & 0xFF;
+        args[1] = BENCH_SAMPLE_PERIOD_MS >> 8;
+        args[2] = target->address;
+        args[4] = 1;
+        break;
+    }
+}
+
+static EXEC_STATUS execBenchSetup(struct BenchTarget *target, unsigned char command, unsigned char data)
+{
+    unsigned char request[USB_SET_COMMAND_BUFFER_SIZE];
+    unsigned char response[USB_GET_DATA_BUFFER_SIZE];
+    uint64_t latencyNs;
+
+    setUSBBuffer(request, command, data);
+    if(execBenchRequest(target, request, response, &latencyNs, NULL) == EXEC_FAIL)
+    {
+        return EXEC_FAIL;
+    }
+
+    return isBenchFailure(response) ? EXEC_FAIL : EXEC_SUCCESS;
+}
+
+static EXEC_STATUS prepareBenchBus(struct BenchTarget *target, unsigned char flags)
+{
+    if((flags & BENCH_PRE_MASK) == 0)
+    {
+        return EXEC_SUCCESS;
+    }
+
+    if(execBenchSetup(target, USB_CMD_I2C_START, 0x00) == EXEC_FAIL)
+    {
+        return EXEC_FAIL;
+    }
+
+    if(flags & (BENCH_PRE_SLA_W | BENCH_PRE_SLA_R))
+    {
+        // Slave address with the direction of the measured transfer.
+        return execBenchSetup(target, USB_CMD_I2C_WRITE_ADDR, (target->address << 1) | ((flags & BENCH_PRE_SLA_R) ? 0x01 : 0x00));
+    }
+
+    return EXEC_SUCCESS;
+}
+
+static int compareLatency(const void *first, const void *second)
+{
+    uint64_t firstValue = *(const uint64_t *)first;
+    uint64_t secondValue = *(const uint64_t *)second;
+
+    return (firstValue > secondValue) - (firstValue < secondValue);
+}
+
+static uint64_t getLatencyPercentile(const uint64_t *latencies, unsigned int count, unsigned int percentile)
+{
+    unsigned int rank;
+
+    // Nearest-rank percentile of the sorted latencies.
+    rank = (((uint64_t)count * percentile) + 99) / 100;
+    return latencies[(rank > 0) ? (rank - 1) : 0];
+}
+
+static unsigned int execPipelinedCase(struct BenchTarget *target, const struct BenchCase *benchCase, unsigned int iterations, 
+    uint64_t *latencies, uint64_t *totalPolls, struct BenchResult *result)
+{
+    unsigned char requests[BENCH_PIPELINE_DEPTH][USB_SET_COMMAND_BUFFER_SIZE];
+    unsigned char responses[BENCH_PIPELINE_DEPTH][USB_GET_DATA_BUFFER_SIZE];
+    struct DevRequest devRequests[BENCH_PIPELINE_DEPTH], *completed;
+    unsigned int submitted = 0, collected = 0, sampleCount = 0, slotPos;
+    uint64_t lastTime, completeTime;
+
+    // Latency of a pipelined request is the interval between two completions, which is lower than the round-trip
+    // time of the same command if the transport overlaps the requests.
+    lastTime = getCaptureClock();
+    while(collected < iterations)
+    {
+        // Keep the window of outstanding requests full.
+        while((submitted < iterations) && ((submitted - collected) < BENCH_PIPELINE_DEPTH))
+        {
+            slotPos = submitted % BENCH_PIPELINE_DEPTH;
+            buildBenchRequest(target, benchCase, requests[slotPos]);
+            devRequests[slotPos].request = requests[slotPos];
+            devRequests[slotPos].response = responses[slotPos];
+            devRequests[slotPos].callback = NULL;
+            devRequests[slotPos].context = NULL;
+
+            if(submitDevRequest(&target->worker, &devRequests[slotPos], 1) == EXEC_FAIL)
+            {
+                // Remaining iterations are failed, only the outstanding requests are collected.
+                result->errors += iterations - submitted;
+                iterations = submitted;
+                break;
+            }
+
+            submitted++;
+        }
+
+        completed = getDevResult(&target->worker, 1);
+        if(completed == NULL)
+        {
+            result->errors += iterations - collected;
+            break;
+        }
+
+        collected++;
+        completeTime = getCaptureClock();
+
+        if((completed->status == EXEC_SUCCESS) && !isBenchFailure(completed->response))
+        {
+            latencies[sampleCount++] = completeTime - lastTime;
+            *totalPolls += completed->pollCount;
+            result->maxPolls = (completed->pollCount > result->maxPolls) ? completed->pollCount : result->maxPolls;
+        }
+        else
+        {
+            result->errors++;
+        }
+
+        lastTime = completeTime;
+    }
+
+    return sampleCount;
+}
+
+EXEC_STATUS runLatencyCase(struct BenchTarget *target, const struct BenchCase *benchCase, unsigned int iterations, struct BenchResult *result)
+{
+    unsigned char request[USB_SET_COMMAND_BUFFER_SIZE];
+    unsigned char response[USB_GET_DATA_BUFFER_SIZE];
+    uint64_t *latencies, latencyNs, totalPolls = 0;
+    unsigned int iteration, pollCount, sampleCount = 0;
+    EXEC_STATUS setupStatus;
+
+    memset(result, 0, sizeof(struct BenchResult));
+    result->benchCase = benchCase;
+    result->iterations = iterations;
+
+    latencies = malloc(sizeof(uint64_t) * iterations);
+    if(latencies == NULL)
+    {
+        return EXEC_FAIL;
+    }
+
+    if(benchCase->flags & BENCH_PIPELINED)
+    {
+        sampleCount = execPipelinedCase(target, benchCase, iterations, latencies, &totalPolls, result);
+    }
+    else
+    {
+        for(iteration = 0; iteration < iterations; iteration++)
+        {
+            setupStatus = prepareBenchBus(target, benchCase->flags);
+            if(setupStatus == EXEC_SUCCESS)
+            {
+                // Only the measured command is timed, setup and cleanup requests are excluded.
+                buildBenchRequest(target, benchCase, request);
+                if((execBenchRequest(target, request, response, &latencyNs, &pollCount) == EXEC_SUCCESS) && !isBenchFailure(response))
+                {
+                    latencies[sampleCount++] = latencyNs;
+                    totalPolls += pollCount;
+                    result->maxPolls = (pollCount > result->maxPolls) ? pollCount : result->maxPolls;
+                }
+                else
+                {
+                    result->errors++;
+                }
+            }
+            else
+            {
+                result->errors++;
+            }
+
+            if((benchCase->flags & BENCH_POST_STOP) || ((setupStatus == EXEC_FAIL) && (benchCase->flags & BENCH_PRE_MASK)))
+            {
+                // Release the bus for the next iteration.
+                execBenchSetup(target, USB_CMD_I2C_STOP, 0x00);
+            }
+        }
+    }
+
+    if(sampleCount > 0)
+    {
+        qsort(latencies, sampleCount, sizeof(uint64_t), compareLatency);
+
+        result->minNs = latencies[0];
+        result->p50Ns = getLatencyPercentile(latencies, sampleCount, 50);
+        result->p99Ns = getLatencyPercentile(latencies, sampleCount, 99);
+        result->maxNs = latencies[sampleCount - 1];
+        result->averagePolls = (double)totalPolls / sampleCount;
+    }
+
+    free(latencies);
+    return EXEC_SUCCESS;
+}
+
+static void printLatencyResult(const struct BenchResult *result, FILE *csvFile)
+{
+    if(result->errors < result->iterations)
+    {
+        printf(BENCH_MSG_LATENCY_ROW, result->benchCase->name, result->iterations, result->errors, result->minNs / 1000.0, 
+            result->p50Ns / 1000.0, result->p99Ns / 1000.0, result->maxNs / 1000.0, result->averagePolls, result->maxPolls);
+    }
+    else
+    {
+        // None of the iterations are completed.
+        printf(BENCH_MSG_LATENCY_FAIL, result->benchCase->name, result->iterations, result->errors);
+    }
+
+    if(csvFile != NULL)
+    {
+        fprintf(csvFile, BENCH_CSV_LATENCY_ROW, result->benchCase->name, result->benchCase->command, result->iterations, result->errors, 
+            result->minNs / 1000.0, result->p50Ns / 1000.0, result->p99Ns / 1000.0, result->maxNs / 1000.0, result->averagePolls, result->maxPolls);
+    }
+}
+
+EXEC_STATUS runLatencySuite(struct BenchTarget *target, const char *caseList, unsigned int iterations, FILE *csvFile)
+{
+    const struct BenchCase *benchCase;
+    struct BenchResult result;
+    char *listBuffer = NULL, *name, *savePtr;
+    EXEC_STATUS status = EXEC_SUCCESS;
+    unsigned int failedCases = 0;
+
+    printf(BENCH_MSG_LATENCY_HEADER);
+    if(csvFile != NULL)
+    {
+        fprintf(csvFile, BENCH_CSV_LATENCY_HEADER);
+    }
+
+    if(caseList == NULL)
+    {
+        // Run all the command types which do not disturb the slaves.
+        for(benchCase = benchCases; (benchCase->name != NULL) && (status == EXEC_SUCCESS); benchCase++)
+        {
+            if((benchCase->flags & BENCH_EXPLICIT) == 0)
+            {
+                status = runLatencyCase(target, benchCase, iterations, &result);
+                printLatencyResult(&result, csvFile);
+                failedCases += (result.errors > 0);
+            }
+        }
+
+        // Suite fails if any of the iterations is failed, to catch the regressions in the scripts.
+        return (failedCases > 0) ? EXEC_FAIL : status;
+    }
+
+    // Comma separated list of the command types.
+    listBuffer = strdup(caseList);
+    if(listBuffer == NULL)
+    {
+        return EXEC_FAIL;
+    }
+
+    for(name = strtok_r(listBuffer, ",", &savePtr); (name != NULL) && (status == EXEC_SUCCESS); name = strtok_r(NULL, ",", &savePtr))
+    {
+        benchCase = findBenchCase(name);
+        if(benchCase == NULL)
+        {
+            printCommandError(BENCH_CASE_UNKNOWN, name);
+            status = EXEC_FAIL;
+            break;
+        }
+
+        status = runLatencyCase(target, benchCase, iterations, &result);
+        printLatencyResult(&result, csvFile);
+        failedCases += (result.errors > 0);
+    }
+
+    free(listBuffer);
+    return (failedCases > 0) ? EXEC_FAIL : status;
+}
\ No newline at end of file
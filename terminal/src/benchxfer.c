@@ -0,0 +1,446 @@
+//----------------------------------------------------------------------------------
+// I2C Test Terminal - Throughput Benchmark.
+//
+// Copyright (c) 2021 Dilshan R Jayakody [jayakody2000lk@gmail.com].
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//----------------------------------------------------------------------------------
+
+#include "bench.h"
+#include "termutil.h"
+#include "strdef.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// SCL cycles of the bus conditions and a byte transfer (8 data bits and the acknowledge bit).
+#define XFER_CONDITION_CYCLES   1
+#define XFER_BYTE_CYCLES        9
+
+static const char *xferPathNames[BENCH_XFER_PATHS] = {"primitive", "register", "bulk"};
+
+// State of a single transfer phase.
+struct BenchXfer
+{
+    struct BenchTarget *target;
+    const struct BenchRegion *region;
+    struct BenchXferResult *result;
+    unsigned char request[USB_SET_COMMAND_BUFFER_SIZE];
+    unsigned char response[USB_GET_DATA_BUFFER_SIZE];
+};
+
+static EXEC_STATUS execXferRequest(struct BenchXfer *xfer, unsigned long busCycles)
+{
+    uint64_t latencyNs;
+    unsigned int pollCount;
+    unsigned long transferCount = xfer->target->transport.transferCount;
+    EXEC_STATUS status;
+
+    xfer->result->requests++;
+    xfer->result->busCycles += busCycles;
+
+    // Transport counts the request, resends, feature reports and completion records of the request.
+    status = execBenchRequest(xfer->target, xfer->request, xfer->response, &latencyNs, &pollCount);
+    xfer->result->transfers += xfer->target->transport.transferCount - transferCount;
+
+    if(status == EXEC_FAIL)
+    {
+        return EXEC_FAIL;
+    }
+
+    xfer->result->polls += pollCount;
+    return isBenchFailure(xfer->response) ? EXEC_FAIL : EXEC_SUCCESS;
+}
+
+static EXEC_STATUS execXferPrimitive(struct BenchXfer *xfer, unsigned char command, unsigned char data, unsigned char expected)
+{
+    unsigned long busCycles;
+
+    setUSBBuffer(xfer->request, command, data);
+    busCycles = ((command == USB_CMD_I2C_START) || (command == USB_CMD_I2C_STOP)) ? XFER_CONDITION_CYCLES : XFER_BYTE_CYCLES;
+
+    if(execXferRequest(xfer, busCycles) == EXEC_FAIL)
+    {
+        return EXEC_FAIL;
+    }
+
+    // START is reported as repeated START inside a transaction.
+    if((expected == TWI_STATUS_START) && (xfer->response[3] == TWI_STATUS_REP_START))
+    {
+        return EXEC_SUCCESS;
+    }
+
+    return ((expected == RET_SUCCESS) || (xfer->response[3] == expected)) ? EXEC_SUCCESS : EXEC_FAIL;
+}
+
+static unsigned char getXferSlave(struct BenchXfer *xfer, unsigned int offset)
+{
+    // Small EEPROMs select the 256 byte block with the low bits of the slave address.
+    return (xfer->region->addrBytes == 1) ? (xfer->target->address | ((offset >> 8) & 0x07)) : xfer->target->address;
+}
+
+static unsigned char setXferAddress(struct BenchXfer *xfer, unsigned int offset, unsigned char *buffer)
+{
+    // Memory address is sent MSB first.
+    if(xfer->region->addrBytes == 2)
+    {
+        buffer[0] = (offset >> 8) & 0xFF;
+        buffer[1] = offset & 0xFF;
+        return 2;
+    }
+
+    buffer[0] = offset & 0xFF;
+    return 1;
+}
+
+static unsigned char getXferPattern(unsigned char path, unsigned int offset)
+{
+    // Each path writes a different pattern, so the read back verifies the data of the same path.
+    return (unsigned char)((offset * 7) + (path * 0x55) + 1);
+}
+
+static EXEC_STATUS selectXferSlave(struct BenchXfer *xfer, unsigned int offset, unsigned char read)
+{
+    unsigned char address[2];
+    unsigned char addrLength, addrPos;
+
+    if((execXferPrimitive(xfer, USB_CMD_I2C_START, 0x00, TWI_STATUS_START) == EXEC_FAIL) ||
+        (execXferPrimitive(xfer, USB_CMD_I2C_WRITE_ADDR, getXferSlave(xfer, offset) << 1, TWI_STATUS_MT_SLA_ACK) == EXEC_FAIL))
+    {
+        return EXEC_FAIL;
+    }
+
+    // Memory address of the transfer.
+    addrLength = setXferAddress(xfer, offset, address);
+    for(addrPos = 0; addrPos < addrLength; addrPos++)
+    {
+        if(execXferPrimitive(xfer, USB_CMD_I2C_WRITE, address[addrPos], TWI_STATUS_MT_DATA_ACK) == EXEC_FAIL)
+        {
+            return EXEC_FAIL;
+        }
+    }
+
+    if(read)
+    {
+        // Repeated START to continue with the sequential read.
+        if((execXferPrimitive(xfer, USB_CMD_I2C_START, 0x00, TWI_STATUS_START) == EXEC_FAIL) ||
+            (execXferPrimitive(xfer, USB_CMD_I2C_WRITE_ADDR, (getXferSlave(xfer, offset) << 1) | 0x01, TWI_STATUS_MR_SLA_ACK) == EXEC_FAIL))
+        {
+            return EXEC_FAIL;
+        }
+    }
+
+    return EXEC_SUCCESS;
+}
+
+static EXEC_STATUS waitXferWriteCycle(struct BenchXfer *xfer, unsigned int offset)
+{
+    unsigned char *args = &xfer->request[USB_REQ_HEADER_SIZE];
+    unsigned int pollPos;
+
+    // EEPROM does not acknowledge its address until the internal write cycle is completed.
+    for(pollPos = 0; pollPos < BENCH_ACK_POLL_LIMIT; pollPos++)
+    {
+        setUSBBuffer(xfer->request, USB_CMD_BATCH, 3);
+        args[0] = USB_CMD_I2C_START;
+        args[2] = USB_CMD_I2C_WRITE_ADDR;
+        args[3] = (getXferSlave(xfer, offset) << 1);
+        args[4] = USB_CMD_I2C_STOP;
+
+        xfer->result->ackPolls++;
+        if(execXferRequest(xfer, XFER_BYTE_CYCLES + (XFER_CONDITION_CYCLES * 2)) == EXEC_FAIL)
+        {
+            return EXEC_FAIL;
+        }
+
+        if(xfer->response[1 + USB_RESP_HEADER_SIZE + 2] == TWI_STATUS_MT_SLA_ACK)
+        {
+            return EXEC_SUCCESS;
+        }
+    }
+
+    return EXEC_FAIL;
+}
+
+static EXEC_STATUS writeXferChunk(struct BenchXfer *xfer, unsigned int offset, const unsigned char *data, unsigned int length)
+{
+    unsigned char *args = &xfer->request[USB_REQ_HEADER_SIZE];
+    unsigned char addrLength;
+    unsigned int dataPos;
+    EXEC_STATUS status = EXEC_SUCCESS;
+
+    switch(xfer->result->path)
+    {
+    case BENCH_XFER_PRIMITIVE:
+        status = selectXferSlave(xfer, offset, 0);
+        for(dataPos = 0; (dataPos < length) && (status == EXEC_SUCCESS); dataPos++)
+        {
+            status = execXferPrimitive(xfer, USB_CMD_I2C_WRITE, data[dataPos], TWI_STATUS_MT_DATA_ACK);
+        }
+        break;
+    case BENCH_XFER_REGISTER:
+        // Memory address is the register, register path is used only with the 1-byte memory address.
+        setUSBBuffer(xfer->request, USB_CMD_I2C_WRITE_REG, getXferSlave(xfer, offset));
+        args[0] = offset & 0xFF;
+        args[1] = length;
+        memcpy(&args[2], data, length);
+
+        status = execXferRequest(xfer, (XFER_CONDITION_CYCLES * 2) + ((2 + length) * XFER_BYTE_CYCLES));
+        status = ((status == EXEC_SUCCESS) && (xfer->response[4] == length)) ? EXEC_SUCCESS : EXEC_FAIL;
+        return (status == EXEC_SUCCESS) ? waitXferWriteCycle(xfer, offset) : EXEC_FAIL;
+    case BENCH_XFER_BULK:
+        if((execXferPrimitive(xfer, USB_CMD_I2C_START, 0x00, TWI_STATUS_START) == EXEC_FAIL) ||
+            (execXferPrimitive(xfer, USB_CMD_I2C_WRITE_ADDR, getXferSlave(xfer, offset) << 1, TWI_STATUS_MT_SLA_ACK) == EXEC_FAIL))
+        {
+            status = EXEC_FAIL;
+            break;
+        }
+
+        // Memory address and the data bytes are sent with a single request.
+        setUSBBuffer(xfer->request, USB_CMD_I2C_WRITE_BULK, 0x00);
+        addrLength = setXferAddress(xfer, offset, args);
+        memcpy(&args[addrLength], data, length);
+        xfer->request[2] = addrLength + length;
+
+        status = execXferRequest(xfer, xfer->request[2] * XFER_BYTE_CYCLES);
+        status = ((status == EXEC_SUCCESS) && (xfer->response[4] == (addrLength + length))) ? EXEC_SUCCESS : EXEC_FAIL;
+        break;
+    }
+
+    // Release the bus to start the write cycle of the page.
+    execXferPrimitive(xfer, USB_CMD_I2C_STOP, 0x00, RET_SUCCESS);
+    return (status == EXEC_SUCCESS) ? waitXferWriteCycle(xfer, offset) : EXEC_FAIL;
+}
+
+static EXEC_STATUS readXferChunk(struct BenchXfer *xfer, unsigned int offset, unsigned char *data, unsigned int length)
+{
+    unsigned char *args = &xfer->request[USB_REQ_HEADER_SIZE];
+    unsigned int dataPos;
+    EXEC_STATUS status;
+
+    if(xfer->result->path == BENCH_XFER_REGISTER)
+    {
+        // Register address, repeated START and the sequential read in a single request.
+        setUSBBuffer(xfer->request, USB_CMD_I2C_READ_REG, getXferSlave(xfer, offset));
+        args[0] = offset & 0xFF;
+        args[1] = length;
+
+        status = execXferRequest(xfer, (XFER_CONDITION_CYCLES * 3) + ((3 + length) * XFER_BYTE_CYCLES));
+        if((status == EXEC_SUCCESS) && (xfer->response[4] == length))
+        {
+            memcpy(data, &xfer->response[1 + USB_RESP_HEADER_SIZE], length);
+            return EXEC_SUCCESS;
+        }
+
+        return EXEC_FAIL;
+    }
+
+    status = selectXferSlave(xfer, offset, 1);
+    if((status == EXEC_SUCCESS) && (xfer->result->path == BENCH_XFER_PRIMITIVE))
+    {
+        // ACK all the bytes except the last one.
+        for(dataPos = 0; (dataPos < length) && (status == EXEC_SUCCESS); dataPos++)
+        {
+            status = execXferPrimitive(xfer, USB_CMD_I2C_READ, (dataPos < (length - 1)), RET_SUCCESS);
+            data[dataPos] = xfer->response[4];
+        }
+    }
+    else if(status == EXEC_SUCCESS)
+    {
+        setUSBBuffer(xfer->request, USB_CMD_I2C_READ_BULK, length);
+        status = execXferRequest(xfer, length * XFER_BYTE_CYCLES);
+        status = ((status == EXEC_SUCCESS) && (xfer->response[4] == length)) ? EXEC_SUCCESS : EXEC_FAIL;
+        memcpy(data, &xfer->response[1 + USB_RESP_HEADER_SIZE], length);
+    }
+
+    execXferPrimitive(xfer, USB_CMD_I2C_STOP, 0x00, RET_SUCCESS);
+    return status;
+}
+
+static unsigned int getXferChunk(struct BenchXfer *xfer, unsigned int offset, unsigned int remaining, unsigned char write)
+{
+    unsigned int chunk = remaining, limit;
+
+    if(write)
+    {
+        // Page write must not cross the page boundary, address counter rolls over within the page.
+        limit = xfer->region->pageSize - (offset % xfer->region->pageSize);
+        chunk = (chunk > limit) ? limit : chunk;
+        limit = (xfer->result->path == BENCH_XFER_REGISTER) ? REG_MAX_WRITE_COUNT : 
+            ((xfer->result->path == BENCH_XFER_BULK) ? (BULK_MAX_WRITE_COUNT - xfer->region->addrBytes) : chunk);
+    }
+    else
+    {
+        limit = (xfer->result->path == BENCH_XFER_REGISTER) ? REG_MAX_READ_COUNT : BULK_MAX_READ_COUNT;
+    }
+
+    chunk = (chunk > limit) ? limit : chunk;
+
+    if(xfer->region->addrBytes == 1)
+    {
+        // 256 byte block is selected by the slave address.
+        limit = 0x100 - (offset & 0xFF);
+        chunk = (chunk > limit) ? limit : chunk;
+    }
+
+    return chunk;
+}
+
+static EXEC_STATUS runXferPhase(struct BenchTarget *target, const struct BenchRegion *region, unsigned char path, unsigned char write, 
+    unsigned char *data, struct BenchXferResult *result)
+{
+    struct BenchXfer xfer;
+    unsigned int done, chunk;
+    uint64_t startTime;
+
+    memset(result, 0, sizeof(struct BenchXferResult));
+    result->path = path;
+    result->write = write;
+    result->length = region->length;
+
+    xfer.target = target;
+    xfer.region = region;
+    xfer.result = result;
+
+    if(write)
+    {
+        for(done = 0; done < region->length; done++)
+        {
+            data[done] = getXferPattern(path, region->offset + done);
+        }
+    }
+
+    startTime = getCaptureClock();
+
+    for(done = 0; done < region->length; done += chunk)
+    {
+        chunk = getXferChunk(&xfer, region->offset + done, region->length - done, write);
+        if((write ? writeXferChunk(&xfer, region->offset + done, &data[done], chunk) : 
+            readXferChunk(&xfer, region->offset + done, &data[done], chunk)) == EXEC_FAIL)
+        {
+            // Chunk is not transferred, read back of the chunk is also reported as mismatch.
+            result->errors++;
+        }
+    }
+
+    result->elapsedNs = getCaptureClock() - startTime;
+    return EXEC_SUCCESS;
+}
+
+static unsigned int getXferBusClock(struct BenchTarget *target)
+{
+    switch(target->comSpeed)
+    {
+    case TWI_COM_SPEED_250:
+        return 250;
+    case TWI_COM_SPEED_400:
+        return 400;
+    }
+
+    return 100;
+}
+
+static void printXferResult(struct BenchTarget *target, const struct BenchXferResult *result, FILE *csvFile)
+{
+    double elapsed = result->elapsedNs / 1000000000.0;
+    double busTime = (double)result->busCycles / (getXferBusClock(target) * 1000.0);
+    double bytesPerSecond = (elapsed > 0) ? (result->length / elapsed) : 0;
+    double transfersPerByte = (result->length > 0) ? ((double)result->transfers / result->length) : 0;
+    double busUtilisation = (elapsed > 0) ? ((busTime * 100.0) / elapsed) : 0;
+    unsigned char busTiming = ((getTransportCapabilities(&target->transport) & TRANSPORT_CAP_HARDWARE) != 0);
+    char utilisationText[16];
+
+    // Bus time is estimated from the SCL cycles, so it can exceed the wall time on short phases. Utilisation is not
+    // available if the transport does not model the bus timing.
+    snprintf(utilisationText, sizeof(utilisationText), "%.1f", (busUtilisation > 100.0) ? 100.0 : busUtilisation);
+
+    printf(BENCH_MSG_XFER_ROW, xferPathNames[result->path], result->write ? "write" : "read", result->length, result->errors, 
+        elapsed * 1000.0, bytesPerSecond, result->requests, result->polls, result->ackPolls, transfersPerByte, (busTiming ? utilisationText : "-"));
+
+    if(csvFile != NULL)
+    {
+        fprintf(csvFile, BENCH_CSV_XFER_ROW, xferPathNames[result->path], result->write ? "write" : "read", result->length, result->errors, 
+            elapsed * 1000.0, bytesPerSecond, result->requests, result->polls, result->ackPolls, transfersPerByte, (busTiming ? utilisationText : ""));
+    }
+}
+
+EXEC_STATUS runThroughputSuite(struct BenchTarget *target, const struct BenchRegion *region, FILE *csvFile)
+{
+    struct BenchXferResult result;
+    unsigned char *data, *reference;
+    unsigned char path;
+    unsigned int dataPos, failedPhases = 0;
+
+    data = malloc(region->length);
+    reference = malloc(region->length);
+    if((data == NULL) || (reference == NULL))
+    {
+        free(data);
+        free(reference);
+        return EXEC_FAIL;
+    }
+
+    printf(BENCH_MSG_XFER_REGION, region->offset, region->length, region->pageSize, region->addrBytes, getXferBusClock(target));
+    printf(BENCH_MSG_XFER_HEADER);
+    if(csvFile != NULL)
+    {
+        fprintf(csvFile, BENCH_CSV_XFER_HEADER);
+    }
+
+    for(path = 0; path < BENCH_XFER_PATHS; path++)
+    {
+        if((path == BENCH_XFER_REGISTER) && (region->addrBytes != 1))
+        {
+            // Register read sends a single address byte before the repeated START.
+            printf(BENCH_MSG_XFER_SKIP, xferPathNames[path]);
+            continue;
+        }
+
+        if(!region->readOnly)
+        {
+            runXferPhase(target, region, path, 1, reference, &result);
+            printXferResult(target, &result, csvFile);
+            failedPhases += (result.errors > 0);
+        }
+
+        runXferPhase(target, region, path, 0, data, &result);
+
+        if(region->readOnly && (path == BENCH_XFER_PRIMITIVE))
+        {
+            // Content of the slave is not known, other paths are verified with the data of the first path.
+            memcpy(reference, data, region->length);
+        }
+        else
+        {
+            for(dataPos = 0; dataPos < region->length; dataPos++)
+            {
+                result.errors += (data[dataPos] != reference[dataPos]);
+            }
+        }
+
+        printXferResult(target, &result, csvFile);
+        failedPhases += (result.errors > 0);
+    }
+
+    free(data);
+    free(reference);
+
+    // Suite fails if any of the transfers or the verification is failed, to catch the regressions in the scripts.
+    return (failedPhases > 0) ? EXEC_FAIL : EXEC_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,242 @@
+//----------------------------------------------------------------------------------
+// I2C Test Terminal - Binary Transaction Capture Log.
+//
+// Copyright (c) 2021 Dilshan R Jayakody [jayakody2000lk@gmail.com].
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//----------------------------------------------------------------------------------
+
+#include "caplog.h"
+#include "usbproto.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+
+#include <string.h>
+
+// Capture log of the current session, records are appended by the I/O worker of each device.
+static struct CaptureLog activeLog = {-1, 0, NULL, NULL};
+
+static EXEC_STATUS mapCaptureFile(const char *path, struct CaptureLog *log, unsigned char writable, unsigned int capacity)
+{
+    struct stat fileStat;
+    struct CaptureHeader *header;
+    size_t mapSize;
+    unsigned char newFile = 0;
+    void *mapPtr;
+
+    log->header = NULL;
+    log->records = NULL;
+    log->fileHandler = open(path, (writable ? (O_RDWR | O_CREAT) : O_RDONLY), 0644);
+    if(log->fileHandler < 0)
+    {
+        return EXEC_FAIL;
+    }
+
+    if(fstat(log->fileHandler, &fileStat) < 0)
+    {
+        close(log->fileHandler);
+        return EXEC_FAIL;
+    }
+
+    mapSize = (size_t)fileStat.st_size;
+    if(writable && (mapSize == 0))
+    {
+        // New (empty) capture file, allocate the header and the complete ring at once.
+        mapSize = sizeof(struct CaptureHeader) + ((size_t)capacity * sizeof(struct CaptureRecord));
+        if(ftruncate(log->fileHandler, mapSize) < 0)
+        {
+            close(log->fileHandler);
+            return EXEC_FAIL;
+        }
+
+        newFile = 1;
+    }
+
+    if(mapSize < sizeof(struct CaptureHeader))
+    {
+        // File is too small to be a capture log.
+        close(log->fileHandler);
+        return EXEC_FAIL;
+    }
+
+    mapPtr = mmap(NULL, mapSize, (writable ? (PROT_READ | PROT_WRITE) : PROT_READ), MAP_SHARED, log->fileHandler, 0);
+    if(mapPtr == MAP_FAILED)
+    {
+        close(log->fileHandler);
+        return EXEC_FAIL;
+    }
+
+    header = (struct CaptureHeader *)mapPtr;
+    if(newFile)
+    {
+        header->magic = CAPTURE_MAGIC;
+        header->version = CAPTURE_VERSION;
+        header->recordSize = sizeof(struct CaptureRecord);
+        header->capacity = capacity;
+        atomic_store(&header->writeCount, 0);
+    }
+
+    // Existing file is appended only if the layout is the same, other files are never overwritten.
+    if((header->magic != CAPTURE_MAGIC) || (header->version != CAPTURE_VERSION) || (header->recordSize != sizeof(struct CaptureRecord)) ||
+        (header->capacity == 0) || (mapSize < (sizeof(struct CaptureHeader) + ((size_t)header->capacity * sizeof(struct CaptureRecord)))))
+    {
+        munmap(mapPtr, mapSize);
+        close(log->fileHandler);
+        return EXEC_FAIL;
+    }
+
+    log->mapSize = mapSize;
+    log->header = header;
+    log->records = (struct CaptureRecord *)(header + 1);
+
+    return EXEC_SUCCESS;
+}
+
+EXEC_STATUS openCaptureLog(const char *path, unsigned int capacity)
+{
+    closeCaptureLog();
+    return mapCaptureFile(path, &activeLog, 1, ((capacity == 0) ? CAPTURE_DEFAULT_RECORDS : capacity));
+}
+
+void closeCaptureLog()
+{
+    unmapCaptureLog(&activeLog);
+}
+
+unsigned char isCaptureActive()
+{
+    return (activeLog.header != NULL);
+}
+
+uint64_t getCaptureClock()
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000000000ULL) + now.tv_nsec;
+}
+
+void captureTransaction(unsigned char deviceId, const unsigned char *request, const unsigned char *response, EXEC_STATUS status, 
+    unsigned int pollCount, uint64_t startTime)
+{
+    struct CaptureRecord *record;
+    struct timespec now;
+    uint64_t index, latency;
+    unsigned char reqLength, respLength;
+
+    if(activeLog.header == NULL)
+    {
+        // Capture is not enabled in this session.
+        return;
+    }
+
+    // Reserve the next record of the ring, slot is invalid until the sequence is updated.
+    index = atomic_fetch_add(&activeLog.header->writeCount, 1);
+    record = &activeLog.records[index % activeLog.header->capacity];
+    atomic_store_explicit(&record->sequence, 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    latency = (getCaptureClock() - startTime) / 1000;
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    record->timestamp = (((uint64_t)now.tv_sec * 1000000000ULL) + now.tv_nsec) - (latency * 1000);
+    record->latencyUs = (latency > UINT32_MAX) ? UINT32_MAX : (uint32_t)latency;
+    record->pollCount = (pollCount > UINT16_MAX) ? UINT16_MAX : (uint16_t)pollCount;
+    record->deviceId = deviceId;
+    record->execStatus = status;
+
+    // Request: SIGNATURE | COMMAND | DATA0 | END SIGNATURE | TAG | PAYLOAD
+    reqLength = getUSBBufferLength(request);
+    record->command = request[1];
+    record->data = request[2];
+    record->tag = request[4];
+    record->reqLength = reqLength;
+    memset(record->reqPayload, 0, CAPTURE_PAYLOAD_SIZE);
+    memcpy(record->reqPayload, &request[USB_REQ_HEADER_SIZE], 
+        ((reqLength - USB_REQ_HEADER_SIZE) > CAPTURE_PAYLOAD_SIZE) ? CAPTURE_PAYLOAD_SIZE : (reqLength - USB_REQ_HEADER_SIZE));
+
+    // Response (after the report number): SIGNATURE | COMMAND | STATUS | DATA0 | TAG | PAYLOAD
+    respLength = getUSBResponseLength(request);
+    record->status = response[3];
+    record->respData = response[4];
+    record->respLength = respLength;
+    record->reserved = 0;
+    memset(record->respPayload, 0, CAPTURE_PAYLOAD_SIZE);
+    memcpy(record->respPayload, &response[1 + USB_RESP_HEADER_SIZE], 
+        ((respLength - USB_RESP_HEADER_SIZE) > CAPTURE_PAYLOAD_SIZE) ? CAPTURE_PAYLOAD_SIZE : (respLength - USB_RESP_HEADER_SIZE));
+
+    // Publish the record.
+    atomic_store_explicit(&record->sequence, (index + 1), memory_order_release);
+}
+
+EXEC_STATUS mapCaptureLog(const char *path, struct CaptureLog *log)
+{
+    return mapCaptureFile(path, log, 0, 0);
+}
+
+void unmapCaptureLog(struct CaptureLog *log)
+{
+    if(log->header == NULL)
+    {
+        return;
+    }
+
+    munmap(log->header, log->mapSize);
+    close(log->fileHandler);
+
+    log->fileHandler = -1;
+    log->mapSize = 0;
+    log->header = NULL;
+    log->records = NULL;
+}
+
+uint64_t getCaptureFirstIndex(struct CaptureLog *log)
+{
+    uint64_t writeCount = atomic_load(&log->header->writeCount);
+
+    // Older records are overwritten by the ring.
+    return (writeCount > log->header->capacity) ? (writeCount - log->header->capacity) : 0;
+}
+
+uint64_t getCaptureEndIndex(struct CaptureLog *log)
+{
+    return atomic_load(&log->header->writeCount);
+}
+
+EXEC_STATUS getCaptureRecord(struct CaptureLog *log, uint64_t index, struct CaptureRecord *record)
+{
+    const struct CaptureRecord *slot = &log->records[index % log->header->capacity];
+    uint64_t sequence;
+
+    // Copy the record only if it is complete and not overwritten during the copy.
+    sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+    if(sequence != (index + 1))
+    {
+        return EXEC_FAIL;
+    }
+
+    memcpy(record, slot, sizeof(struct CaptureRecord));
+    atomic_thread_fence(memory_order_acquire);
+
+    return (atomic_load_explicit(&slot->sequence, memory_order_relaxed) == sequence) ? EXEC_SUCCESS : EXEC_FAIL;
+}
\ No newline at end of file
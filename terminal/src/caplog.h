@@ -0,0 +1,96 @@
+//----------------------------------------------------------------------------------
+// I2C Test Terminal - Binary Transaction Capture Log.
+//
+// Copyright (c) 2021 Dilshan R Jayakody [jayakody2000lk@gmail.com].
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//----------------------------------------------------------------------------------
+
+#ifndef I2C_TERMINAL_CAPTURE_LOG
+#define I2C_TERMINAL_CAPTURE_LOG
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include <stddef.h>
+
+#include "common.h"
+
+// Capture file: CaptureHeader followed by a ring of fixed size records, shared with mmap.
+#define CAPTURE_MAGIC           0x4C433249  // "I2CL"
+#define CAPTURE_VERSION         2
+#define CAPTURE_DEFAULT_RECORDS 16384
+
+// Complete payload of the largest request / response, both headers are USB_REQ_HEADER_SIZE bytes.
+#define CAPTURE_PAYLOAD_SIZE    (USB_REPORT_SIZE - USB_REQ_HEADER_SIZE)
+
+struct CaptureHeader
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t recordSize;
+    uint32_t capacity;
+    uint32_t reserved0;
+    _Atomic uint64_t writeCount;    // Number of records written since the file is created.
+    uint8_t reserved[40];
+};
+
+// Single request / response exchange, 280 bytes. Sequence is written last (index + 1) to detect
+// the records which are being written or overwritten by the ring.
+struct CaptureRecord
+{
+    _Atomic uint64_t sequence;
+    uint64_t timestamp;             // CLOCK_REALTIME in nanoseconds at the submission.
+    uint32_t latencyUs;
+    uint16_t pollCount;
+    uint8_t deviceId;
+    uint8_t execStatus;             // Host side status (EXEC_STATUS).
+    uint8_t command;
+    uint8_t data;                   // DATA0 of the request.
+    uint8_t tag;
+    uint8_t status;                 // STATUS (TWI status / RET_*) of the response.
+    uint8_t respData;               // DATA0 of the response.
+    uint8_t reqLength;              // Request length including the header.
+    uint8_t respLength;             // Expected response length including the header.
+    uint8_t reserved;
+    uint8_t reqPayload[CAPTURE_PAYLOAD_SIZE];
+    uint8_t respPayload[CAPTURE_PAYLOAD_SIZE];
+};
+
+struct CaptureLog
+{
+    int fileHandler;
+    size_t mapSize;
+    struct CaptureHeader *header;
+    struct CaptureRecord *records;
+};
+
+EXEC_STATUS openCaptureLog(const char *path, unsigned int capacity);
+void closeCaptureLog();
+unsigned char isCaptureActive();
+uint64_t getCaptureClock();
+void captureTransaction(unsigned char deviceId, const unsigned char *request, const unsigned char *response, EXEC_STATUS status, 
+    unsigned int pollCount, uint64_t startTime);
+
+EXEC_STATUS mapCaptureLog(const char *path, struct CaptureLog *log);
+void unmapCaptureLog(struct CaptureLog *log);
+uint64_t getCaptureFirstIndex(struct CaptureLog *log);
+uint64_t getCaptureEndIndex(struct CaptureLog *log);
+EXEC_STATUS getCaptureRecord(struct CaptureLog *log, uint64_t index, struct CaptureRecord *record);
+
+#endif /* I2C_TERMINAL_CAPTURE_LOG */
\ No newline at end of file
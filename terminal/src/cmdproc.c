@@ -23,10 +23,12 @@
 //----------------------------------------------------------------------------------
 
 #include "cmdproc.h"
+#include "usbproto.h"
 #include "termutil.h"
 #include "strdef.h"
 #include "common.h"
 #include "docuproc.h"
+#include "pollctl.h"
 
 #include <readline/readline.h>
 #include <readline/history.h>
@@ -35,10 +37,118 @@
 
 #define RELEASE_STR(x) free(x);x=NULL
 
-#define MAX_TOKEN_COUNT 2
+// Command errors are counted to derive the exit status of the non-interactive session.
+#define reportError(x) (cmdErrorCount++, printErrorMsg(x))
+#define reportCommandError(m, p) (cmdErrorCount++, printCommandError(m, p))
+
+#define MAX_TOKEN_COUNT 128
 
 // List of commands available with I2C terminal.
-const char *cmdList[] = {"help", "init", "start", "stop", "write", "write-address", "read", "output-voltage", "reset", "exit"};
+const char *cmdList[] = {"help", "init", "start", "stop", "write", "write-address", "read", "read-reg", "write-reg", "scan", "output-voltage", "reset", "batch-begin", "batch-end", "poll-mode", "timeout", "sample", "stats", "device", "exit"};
+
+// HID feature buffer of the batch which is currently being recorded.
+static unsigned char *batchBuffer = NULL;
+
+// Non-interactive command sources: semicolon separated command list, script file or pipe.
+static char *scriptBuffer = NULL;
+static char *scriptPos = NULL;
+static FILE *scriptFile = NULL;
+static unsigned char scriptMode = 0;
+
+static unsigned int cmdErrorCount = 0;
+
+// Devices of the session, commands are sent to the selected group or to the @TARGET of the command.
+static const char **deviceNames = NULL;
+static unsigned int deviceCount = 0;
+static unsigned int sessionTarget = 0;
+static unsigned int cmdTarget = 0;
+
+void setCommandScript(const char *script)
+{
+    scriptBuffer = strdup(script);
+    scriptPos = scriptBuffer;
+    scriptMode = 1;
+}
+
+void setCommandFile(FILE *file)
+{
+    scriptFile = file;
+    scriptMode = 1;
+}
+
+unsigned char isInteractive()
+{
+    return !scriptMode;
+}
+
+unsigned int getCommandErrorCount()
+{
+    return cmdErrorCount;
+}
+
+void setCommandDevices(const char **names, unsigned int count)
+{
+    deviceNames = names;
+    deviceCount = (count > MAX_TERM_DEVICES) ? MAX_TERM_DEVICES : count;
+
+    // By default commands are broadcast to all the devices.
+    sessionTarget = (1U << deviceCount) - 1;
+    cmdTarget = sessionTarget;
+}
+
+unsigned int getCommandTarget()
+{
+    return cmdTarget;
+}
+
+char *readScriptCommand()
+{
+    char *cmdStart, *cmdEnd;
+    size_t lineSize;
+
+    while(1)
+    {
+        if(scriptPos != NULL)
+        {
+            // Extract the next command from the current line and skip empty commands.
+            cmdStart = scriptPos + strspn(scriptPos, " \t");
+            cmdEnd = strchr(cmdStart, ';');
+            scriptPos = (cmdEnd != NULL) ? (cmdEnd + 1) : NULL;
+
+            if(cmdEnd == NULL)
+            {
+                cmdEnd = cmdStart + strlen(cmdStart);
+            }
+
+            while((cmdEnd > cmdStart) && ((cmdEnd[-1] == ' ') || (cmdEnd[-1] == '\t')))
+            {
+                cmdEnd--;
+            }
+
+            if(cmdEnd > cmdStart)
+            {
+                return strndup(cmdStart, (cmdEnd - cmdStart));
+            }
+
+            continue;
+        }
+
+        // Current line is completed, get the next line from the script file.
+        RELEASE_STR(scriptBuffer);
+        lineSize = 0;
+
+        if((scriptFile == NULL) || (getline(&scriptBuffer, &lineSize, scriptFile) < 0))
+        {
+            // End of the script.
+            RELEASE_STR(scriptBuffer);
+            return NULL;
+        }
+
+        // Drop line ending and comments.
+        scriptBuffer[strcspn(scriptBuffer, "#\r\n")] = '\0';
+        scriptPos = scriptBuffer;
+    }
+}
 
 char *cmdGenerator(const char *text, int state)
 {
@@ -79,15 +189,44 @@ static char **cmdCompletion(const char *text, int start, int end)
     return matches;
 }
 
-unsigned char *createUSBBuffer(unsigned char cmd, unsigned char data)
+EXEC_STATUS appendBatchOperation(unsigned char cmd, unsigned char data)
+{
+    unsigned char opPos;
+
+    if((cmd != USB_CMD_I2C_START) && (cmd != USB_CMD_I2C_STOP) && (cmd != USB_CMD_I2C_WRITE_ADDR) 
+    && (cmd != USB_CMD_I2C_WRITE) && (cmd != USB_CMD_I2C_READ))
+    {
+        // Only I2C bus operations can be executed inside the batch.
+        reportError(CMD_BATCH_UNSUPPORTED);
+        return EXEC_FAIL;
+    }
+
+    if(batchBuffer[2] >= BATCH_MAX_OPS)
+    {
+        // No space left in the HID feature buffer.
+        reportError(CMD_BATCH_FULL);
+        return EXEC_FAIL;
+    }
+
+    // Add COMMAND | DATA pair to the end of the batch.
+    opPos = getUSBBufferLength(batchBuffer);
+    batchBuffer[opPos] = cmd;
+    batchBuffer[opPos + 1] = data;
+    batchBuffer[2]++;
+
+    return EXEC_SUCCESS;
+}
+
+EXEC_STATUS checkBatchSpace(unsigned int opCount)
 {
-    unsigned char* usbBuffer = calloc(USB_SET_COMMAND_BUFFER_SIZE, 1);
-    usbBuffer[0] = SYS_SIGNATURE;
-    usbBuffer[1] = cmd;
-    usbBuffer[2] = data;
-    usbBuffer[3] = SYS_END_SIGNATURE;
+    if((batchBuffer[2] + opCount) > BATCH_MAX_OPS)
+    {
+        // Command does not fit into the batch, none of its operations are added.
+        reportError(CMD_BATCH_FULL);
+        return EXEC_FAIL;
+    }
 
-    return usbBuffer;
+    return EXEC_SUCCESS;
 }
 
 EXEC_STATUS getSpeed(char **strBuffer, unsigned char *out)
@@ -97,7 +236,7 @@ EXEC_STATUS getSpeed(char **strBuffer, unsigned char *out)
     if((*strBuffer)[0] == '\0')
     {
         // String buffer is empty.
-        printErrorMsg(CMD_MSG_PARAMETER_MISSING);
+        reportError(CMD_MSG_PARAMETER_MISSING);
         return EXEC_FAIL;
     }
 
@@ -121,7 +260,7 @@ EXEC_STATUS getSpeed(char **strBuffer, unsigned char *out)
     else
     {
         // Unsupported I2C speed value.
-        printErrorMsg(CMD_MSG_SPEED_UNSUPPORT);
+        reportError(CMD_MSG_SPEED_UNSUPPORT);
         return EXEC_FAIL;
     }
 
@@ -135,7 +274,7 @@ EXEC_STATUS getByte(char **strBuffer, unsigned char *out)
     if((*strBuffer)[0] == '\0')
     {
         // String buffer is empty.
-        printErrorMsg(CMD_MSG_PARAMETER_MISSING);
+        reportError(CMD_MSG_PARAMETER_MISSING);
         return EXEC_FAIL;
     }
 
@@ -143,7 +282,7 @@ EXEC_STATUS getByte(char **strBuffer, unsigned char *out)
     if((convNum < 0) || (convNum > 0xFF))
     {
         // Value out-of-range!
-        printErrorMsg(CMD_MSG_OUTOF_RANGE);
+        reportError(CMD_MSG_OUTOF_RANGE);
         return EXEC_FAIL;
     }
 
@@ -151,12 +290,30 @@ EXEC_STATUS getByte(char **strBuffer, unsigned char *out)
     return EXEC_SUCCESS;
 }
 
+EXEC_STATUS getSlaveAddress(char **strBuffer, unsigned char *out)
+{
+    if(getByte(strBuffer, out) == EXEC_FAIL)
+    {
+        // Parameter value is invalid or not specified.
+        return EXEC_FAIL;
+    }
+
+    if((*out) > 0x7F)
+    {
+        // Only 7-bit slave addresses are accepted, read/write flag is added by the device.
+        reportError(CMD_MSG_ADDR_OUTOF_RANGE);
+        return EXEC_FAIL;
+    }
+
+    return EXEC_SUCCESS;
+}
+
 EXEC_STATUS getVoltageLevel(char **strBuffer, unsigned char *out)
 {
     if((*strBuffer)[0] == '\0')
     {
         // String buffer is empty.
-        printErrorMsg(CMD_MSG_PARAMETER_MISSING);
+        reportError(CMD_MSG_PARAMETER_MISSING);
         return EXEC_FAIL;
     }
 
@@ -175,16 +332,219 @@ EXEC_STATUS getVoltageLevel(char **strBuffer, unsigned char *out)
     }
 
     // Unsupported read flag.
-    printErrorMsg(CMD_PARAM_INVALID_VOLTAGE);
+    reportError(CMD_PARAM_INVALID_VOLTAGE);
+    return EXEC_FAIL;
+}
+
+EXEC_STATUS getRegisterData(unsigned char cmd, char **strBuffer, unsigned char tokenCount, unsigned char *out)
+{
+    unsigned char dataPos;
+
+    if(cmd == USB_CMD_I2C_READ_REG)
+    {
+        // COUNT is optional for the register read, default is one byte.
+        out[0] = 1;
+        if((tokenCount > 0) && (getByte(strBuffer, &out[0]) == EXEC_FAIL))
+        {
+            return EXEC_FAIL;
+        }
+
+        if((out[0] == 0) || (out[0] > REG_MAX_READ_COUNT))
+        {
+            // Value out-of-range!
+            reportError(CMD_MSG_OUTOF_RANGE);
+            return EXEC_FAIL;
+        }
+
+        return EXEC_SUCCESS;
+    }
+
+    // Register write requires at least one data byte.
+    if((tokenCount == 0) || (tokenCount > REG_MAX_WRITE_COUNT))
+    {
+        reportError((tokenCount == 0) ? CMD_MSG_PARAMETER_MISSING : CMD_MSG_OUTOF_RANGE);
+        return EXEC_FAIL;
+    }
+
+    // Output format: COUNT | DATA...
+    out[0] = tokenCount;
+    for(dataPos = 0; dataPos < tokenCount; dataPos++)
+    {
+        if(getByte(&strBuffer[dataPos], &out[dataPos + 1]) == EXEC_FAIL)
+        {
+            return EXEC_FAIL;
+        }
+    }
+
+    return EXEC_SUCCESS;
+}
+
+EXEC_STATUS getWriteData(char **strBuffer, unsigned char tokenCount, unsigned char *out)
+{
+    unsigned char dataPos;
+
+    if(tokenCount > BULK_MAX_WRITE_COUNT)
+    {
+        // Data bytes do not fit into the request.
+        reportError(CMD_MSG_OUTOF_RANGE);
+        return EXEC_FAIL;
+    }
+
+    for(dataPos = 0; dataPos < tokenCount; dataPos++)
+    {
+        if(getByte(&strBuffer[dataPos], &out[dataPos]) == EXEC_FAIL)
+        {
+            return EXEC_FAIL;
+        }
+    }
+
+    return EXEC_SUCCESS;
+}
+
+EXEC_STATUS getPollStrategy(char **strBuffer, unsigned char *out)
+{
+    if(strcmp((*strBuffer), "immediate") == 0)
+    {
+        // Re-poll the device without any delay.
+        *out = POLL_MODE_IMMEDIATE;
+        return EXEC_SUCCESS;
+    }
+    else if(strcmp((*strBuffer), "spin") == 0)
+    {
+        // Re-poll without delay for a while and then backoff.
+        *out = POLL_MODE_SPIN;
+        return EXEC_SUCCESS;
+    }
+    else if(strcmp((*strBuffer), "backoff") == 0)
+    {
+        // Exponential backoff from the first poll.
+        *out = POLL_MODE_BACKOFF;
+        return EXEC_SUCCESS;
+    }
+    else if(strcmp((*strBuffer), "event") == 0)
+    {
+        // Wait for the completion record on the interrupt-IN endpoint.
+        *out = POLL_MODE_EVENT;
+        return EXEC_SUCCESS;
+    }
+
+    // Unsupported polling mode.
+    reportError(CMD_PARAM_INVALID_POLL);
     return EXEC_FAIL;
 }
 
+EXEC_STATUS getTimeout(char **strBuffer, unsigned char *selector, unsigned short *out)
+{
+    long convNum;
+
+    if(strcmp(strBuffer[0], "start") == 0)
+    {
+        // Wait for the bus to be free to transmit START.
+        *selector = I2C_TIMEOUT_START;
+    }
+    else if(strcmp(strBuffer[0], "stretch") == 0)
+    {
+        // Wait for the slave device to release the clock line.
+        *selector = I2C_TIMEOUT_STRETCH;
+    }
+    else if(strcmp(strBuffer[0], "command") == 0)
+    {
+        // Deadline of the single bus command.
+        *selector = I2C_TIMEOUT_COMMAND;
+    }
+    else if(strcmp(strBuffer[0], "batch") == 0)
+    {
+        // Deadline of the batch and register commands.
+        *selector = I2C_TIMEOUT_BATCH;
+    }
+    else
+    {
+        // Unsupported timeout type.
+        reportError(CMD_PARAM_INVALID_TIMEOUT);
+        return EXEC_FAIL;
+    }
+
+    convNum = strtol(strBuffer[1], NULL, 0);
+    if((convNum < 1) || (convNum > I2C_TIMEOUT_MAX_MS))
+    {
+        // Value out-of-range of the device timer.
+        reportError(CMD_MSG_TIMEOUT_OUTOF_RANGE);
+        return EXEC_FAIL;
+    }
+
+    *out = (unsigned short)convNum;
+    return EXEC_SUCCESS;
+}
+
+EXEC_STATUS getSampleConfig(char **strBuffer, unsigned char tokenCount, unsigned char *count, unsigned char *out)
+{
+    long convNum;
+    unsigned char entryPos, frameSize;
+    unsigned char *entry;
+
+    if((tokenCount < 4) || (((tokenCount - 1) % SAMPLE_ENTRY_SIZE) != 0))
+    {
+        // Period and ADDRESS | REGISTER | LENGTH of each entry are required.
+        reportError(CMD_MSG_PARAMETER_MISSING);
+        return EXEC_FAIL;
+    }
+
+    convNum = strtol(strBuffer[0], NULL, 0);
+    if((convNum < 1) || (convNum > SAMPLE_MAX_PERIOD_MS))
+    {
+        // Value out-of-range of the sampling timer.
+        reportError(CMD_MSG_SAMPLE_PERIOD);
+        return EXEC_FAIL;
+    }
+
+    out[0] = convNum & 0xFF;
+    out[1] = (convNum >> 8) & 0xFF;
+
+    *count = (tokenCount - 1) / SAMPLE_ENTRY_SIZE;
+    if((*count) > SAMPLE_MAX_ENTRIES)
+    {
+        reportError(CMD_MSG_SAMPLE_FRAME);
+        return EXEC_FAIL;
+    }
+
+    frameSize = SAMPLE_FRAME_HEADER;
+    for(entryPos = 0; entryPos < (*count); entryPos++, strBuffer += SAMPLE_ENTRY_SIZE)
+    {
+        // Entry format: ADDRESS | REGISTER | LENGTH (tokens after the period).
+        entry = &out[SAMPLE_CONFIG_HEADER + (entryPos * SAMPLE_ENTRY_SIZE)];
+
+        if((getSlaveAddress(&strBuffer[1], &entry[0]) == EXEC_FAIL) || (getByte(&strBuffer[2], &entry[1]) == EXEC_FAIL) || 
+            (getByte(&strBuffer[3], &entry[2]) == EXEC_FAIL))
+        {
+            // Parameter value is invalid or not specified.
+            return EXEC_FAIL;
+        }
+
+        if((entry[2] == 0) || ((frameSize + entry[2]) > SAMPLE_MAX_FRAME))
+        {
+            // All the registers of a sample must fit into a single frame.
+            reportError(CMD_MSG_SAMPLE_FRAME);
+            return EXEC_FAIL;
+        }
+
+        frameSize += entry[2];
+    }
+
+    return EXEC_SUCCESS;
+}
+
+unsigned char isReadFlag(const char *strBuffer)
+{
+    // Single parameter of the read command is a flag, otherwise it is the number of bytes to read.
+    return ((strcmp(strBuffer, "ack") == 0) || (strcmp(strBuffer, "nack") == 0) || (strcmp(strBuffer, "1") == 0) || (strcmp(strBuffer, "0") == 0));
+}
+
 EXEC_STATUS getReadStatus(char **strBuffer, unsigned char *out)
 {
     if((*strBuffer)[0] == '\0')
     {
         // String buffer is empty.
-        printErrorMsg(CMD_MSG_PARAMETER_MISSING);
+        reportError(CMD_MSG_PARAMETER_MISSING);
         return EXEC_FAIL;
     }
 
@@ -202,10 +562,86 @@ EXEC_STATUS getReadStatus(char **strBuffer, unsigned char *out)
     }
     
     // Unsupported read flag.
-    printErrorMsg(CMD_PARAM_READ_UNSUPPORTED);
+    reportError(CMD_PARAM_READ_UNSUPPORTED);
     return EXEC_FAIL;
 }
 
+EXEC_STATUS getReadCount(char **strBuffer, unsigned char tokenCount, unsigned char *count, unsigned char *lastAck)
+{
+    if(getByte(strBuffer, count) == EXEC_FAIL)
+    {
+        // Parameter value is invalid or not specified.
+        return EXEC_FAIL;
+    }
+
+    if(((*count) == 0) || ((*count) > BULK_MAX_READ_COUNT))
+    {
+        // Requested data does not fit into the response.
+        reportError(CMD_MSG_OUTOF_RANGE);
+        return EXEC_FAIL;
+    }
+
+    // ACK/NACK flag of the last byte is optional, default is NACK.
+    *lastAck = 0;
+    return (tokenCount > 1) ? getReadStatus(&strBuffer[1], lastAck) : EXEC_SUCCESS;
+}
+
+EXEC_STATUS getDeviceTarget(char **strBuffer, unsigned int *out)
+{
+    char *item, *itemEnd, *savePtr;
+    unsigned int devPos;
+    long devIndex;
+
+    if((*strBuffer)[0] == '\0')
+    {
+        // String buffer is empty.
+        reportError(CMD_MSG_PARAMETER_MISSING);
+        return EXEC_FAIL;
+    }
+
+    // Target is a comma separated list of device indexes, device names or "all".
+    *out = 0;
+    for(item = strtok_r((*strBuffer), ",", &savePtr); item != NULL; item = strtok_r(NULL, ",", &savePtr))
+    {
+        if(strcmp(item, "all") == 0)
+        {
+            *out |= (1U << deviceCount) - 1;
+            continue;
+        }
+
+        for(devPos = 0; devPos < deviceCount; devPos++)
+        {
+            if(strcmp(item, deviceNames[devPos]) == 0)
+            {
+                break;
+            }
+        }
+
+        if(devPos >= deviceCount)
+        {
+            // Not a device name, check for the device index.
+            devIndex = strtol(item, &itemEnd, 10);
+            if(((*itemEnd) != '\0') || (devIndex < 0) || (devIndex >= (long)deviceCount))
+            {
+                reportCommandError(CMD_MSG_DEVICE_UNKNOWN, item);
+                return EXEC_FAIL;
+            }
+
+            devPos = (unsigned int)devIndex;
+        }
+
+        *out |= (1U << devPos);
+    }
+
+    if((*out) == 0)
+    {
+        reportError(CMD_MSG_PARAMETER_MISSING);
+        return EXEC_FAIL;
+    }
+
+    return EXEC_SUCCESS;
+}
+
 unsigned char getCommand(unsigned char **cmdParam)
 {
     char *inCmd = NULL;
@@ -215,12 +651,18 @@ unsigned char getCommand(unsigned char **cmdParam)
     char *cmdData[MAX_TOKEN_COUNT];
     unsigned char tokenPos;
     unsigned char paramVal;
+    unsigned char usbCmd;
+    unsigned char regAddr;
+    unsigned char lastAck, bytePos;
+    unsigned short timeoutVal;
+    unsigned int targetVal;
+    char *targetStr;
 
     *cmdParam = NULL;
 
     // Getting input command from the user.
     rl_attempted_completion_function = cmdCompletion;
-    while ((inCmd = readline("> ")) != NULL)
+    while ((inCmd = (scriptMode ? readScriptCommand() : readline((batchBuffer != NULL) ? "batch> " : "> "))) != NULL)
     {
         if(inCmd[0] == '\0')
         {
@@ -228,7 +670,7 @@ unsigned char getCommand(unsigned char **cmdParam)
             RELEASE_STR(inCmd);
             continue;
         }
-        else
+        else if(!scriptMode)
         {
             // Add input command to the history list.
             add_history(inCmd);
@@ -257,6 +699,30 @@ unsigned char getCommand(unsigned char **cmdParam)
             }
         }
 
+        // Command can be addressed to specific device(s) with the @TARGET prefix.
+        cmdTarget = sessionTarget;
+        if(cmdData[0][0] == '@')
+        {
+            targetStr = &cmdData[0][1];
+            if(getDeviceTarget(&targetStr, &cmdTarget) == EXEC_FAIL)
+            {
+                // Target is invalid or not specified.
+                RELEASE_STR(inCmd);
+                continue;
+            }
+
+            if(tokenPos < 2)
+            {
+                // Command is missing after the target. @TARGET <COMMAND>
+                reportCommandError(CMD_MSG_PARAMETER_MISSING, cmdData[0]);
+                RELEASE_STR(inCmd);
+                continue;
+            }
+
+            memmove(&cmdData[0], &cmdData[1], (tokenPos - 1) * sizeof(char*));
+            tokenPos--;
+        }
+
         // Execute commands based on the token values.
         if(strcmp(cmdData[0], "help") == 0)
         {
@@ -274,7 +740,7 @@ unsigned char getCommand(unsigned char **cmdParam)
             if(tokenPos < 2)
             {
                 // Required paramaters are missing. INIT <SPEED>
-                printCommandError(CMD_MSG_PARAMETER_MISSING, cmdData[0]);
+                reportCommandError(CMD_MSG_PARAMETER_MISSING, cmdData[0]);
                 RELEASE_STR(inCmd);
                 continue;
             }
@@ -286,9 +752,7 @@ unsigned char getCommand(unsigned char **cmdParam)
                 continue;
             } 
 
-            // Create HID feature buffer to send to the device.
-            *cmdParam = createUSBBuffer(USB_CMD_I2C_INIT, paramVal); 
-            break;          
+            usbCmd = USB_CMD_I2C_INIT;
         }
         else if(strcmp(cmdData[0], "start") == 0)
         {
@@ -299,9 +763,8 @@ unsigned char getCommand(unsigned char **cmdParam)
                 printWarningMsg(CMD_PARAM_IGNORE);
             }
 
-            // Create HID feature buffer to send to the device.
-            *cmdParam = createUSBBuffer(USB_CMD_I2C_START, 0x00); 
-            break; 
+            usbCmd = USB_CMD_I2C_START;
+            paramVal = 0x00;
         }
         else if(strcmp(cmdData[0], "stop") == 0)
         {
@@ -312,8 +775,38 @@ unsigned char getCommand(unsigned char **cmdParam)
                 printWarningMsg(CMD_PARAM_IGNORE);
             }
 
-            // Create HID feature buffer to send to the device.
-            *cmdParam = createUSBBuffer(USB_CMD_I2C_STOP, 0x00); 
+            usbCmd = USB_CMD_I2C_STOP;
+            paramVal = 0x00;
+        }
+        else if((strcmp(cmdData[0], "write") == 0) && (tokenPos > 2))
+        {
+            // Write sequence of data bytes into I2C bus. WRITE <DATA...>
+            *cmdParam = createUSBBuffer(USB_CMD_I2C_WRITE_BULK, (tokenPos - 1));
+
+            if(getWriteData(&(cmdData[1]), (tokenPos - 1), &((*cmdParam)[USB_REQ_HEADER_SIZE])) == EXEC_FAIL)
+            {
+                // Data bytes are invalid.
+                RELEASE_STR(*cmdParam);
+                RELEASE_STR(inCmd);
+                continue;
+            }
+
+            if(batchBuffer != NULL)
+            {
+                // Batch is active, append a WRITE operation for each byte if all of those fit into the batch.
+                if(checkBatchSpace((*cmdParam)[2]) == EXEC_SUCCESS)
+                {
+                    for(bytePos = 0; bytePos < (*cmdParam)[2]; bytePos++)
+                    {
+                        appendBatchOperation(USB_CMD_I2C_WRITE, (*cmdParam)[USB_REQ_HEADER_SIZE + bytePos]);
+                    }
+                }
+
+                RELEASE_STR(*cmdParam);
+                RELEASE_STR(inCmd);
+                continue;
+            }
+
             break;
         }
         else if(strcmp(cmdData[0], "write") == 0)
@@ -322,7 +815,7 @@ unsigned char getCommand(unsigned char **cmdParam)
             if(tokenPos < 2)
             {
                 // Required paramaters are missing. WRITE <DATA>
-                printCommandError(CMD_MSG_PARAMETER_MISSING, cmdData[0]);
+                reportCommandError(CMD_MSG_PARAMETER_MISSING, cmdData[0]);
                 RELEASE_STR(inCmd);
                 continue;
             }
@@ -334,9 +827,7 @@ unsigned char getCommand(unsigned char **cmdParam)
                 continue;
             } 
 
-            // Create HID feature buffer to send to the device.
-            *cmdParam = createUSBBuffer(USB_CMD_I2C_WRITE, paramVal); 
-            break;   
+            usbCmd = USB_CMD_I2C_WRITE;
         }
         else if(strcmp(cmdData[0], "write-address") == 0)
         {
@@ -344,7 +835,7 @@ unsigned char getCommand(unsigned char **cmdParam)
             if(tokenPos < 2)
             {
                 // Required paramaters are missing. WRITE-ADDRESS <ADDRESS | READ/WRITE>
-                printCommandError(CMD_MSG_PARAMETER_MISSING, cmdData[0]);
+                reportCommandError(CMD_MSG_PARAMETER_MISSING, cmdData[0]);
                 RELEASE_STR(inCmd);
                 continue;
             }
@@ -356,9 +847,37 @@ unsigned char getCommand(unsigned char **cmdParam)
                 continue;
             } 
 
-            // Create HID feature buffer to send to the device.
-            *cmdParam = createUSBBuffer(USB_CMD_I2C_WRITE_ADDR, paramVal); 
-            break;   
+            usbCmd = USB_CMD_I2C_WRITE_ADDR;
+        }
+        else if((strcmp(cmdData[0], "read") == 0) && (tokenPos >= 2) && !((tokenPos == 2) && isReadFlag(cmdData[1])))
+        {
+            // Read specified number of bytes from slave device. READ <COUNT> {FLAG}
+            if(getReadCount(&(cmdData[1]), (tokenPos - 1), &paramVal, &lastAck) == EXEC_FAIL)
+            {
+                // Parameter value is invalid or not specified.
+                RELEASE_STR(inCmd);
+                continue;
+            }
+
+            if(batchBuffer != NULL)
+            {
+                // Batch is active, append a READ operation for each byte if all of those fit into the batch.
+                if(checkBatchSpace(paramVal) == EXEC_SUCCESS)
+                {
+                    for(bytePos = 0; bytePos < paramVal; bytePos++)
+                    {
+                        appendBatchOperation(USB_CMD_I2C_READ, ((bytePos < (paramVal - 1)) || lastAck));
+                    }
+                }
+
+                RELEASE_STR(inCmd);
+                continue;
+            }
+
+            // Request format: HEADER | LAST ACK
+            *cmdParam = createUSBBuffer(USB_CMD_I2C_READ_BULK, paramVal);
+            (*cmdParam)[USB_REQ_HEADER_SIZE] = lastAck;
+            break;
         }
         else if(strcmp(cmdData[0], "read") == 0)
         {
@@ -379,9 +898,68 @@ unsigned char getCommand(unsigned char **cmdParam)
                 paramVal = 0;
             }
 
-            // Create HID feature buffer to send to the device.
-            *cmdParam = createUSBBuffer(USB_CMD_I2C_READ, paramVal); 
-            break;            
+            usbCmd = USB_CMD_I2C_READ;
+        }
+        else if((strcmp(cmdData[0], "read-reg") == 0) || (strcmp(cmdData[0], "write-reg") == 0))
+        {
+            // Register read or write as a single combined I2C transaction.
+            if(batchBuffer != NULL)
+            {
+                // Register commands are complete transactions and cannot be part of a batch.
+                reportError(CMD_BATCH_UNSUPPORTED);
+                RELEASE_STR(inCmd);
+                continue;
+            }
+
+            if(tokenPos < 3)
+            {
+                // Required paramaters are missing. READ-REG <ADDRESS> <REGISTER> [COUNT] / WRITE-REG <ADDRESS> <REGISTER> <DATA...>
+                reportCommandError(CMD_MSG_PARAMETER_MISSING, cmdData[0]);
+                RELEASE_STR(inCmd);
+                continue;
+            }
+
+            usbCmd = (cmdData[0][0] == 'r') ? USB_CMD_I2C_READ_REG : USB_CMD_I2C_WRITE_REG;
+            if((getSlaveAddress(&(cmdData[1]), &paramVal) == EXEC_FAIL) || (getByte(&(cmdData[2]), &regAddr) == EXEC_FAIL))
+            {
+                // Parameter value is invalid or not specified.
+                RELEASE_STR(inCmd);
+                continue;
+            }
+
+            // Request format: HEADER | REGISTER | COUNT | DATA...
+            *cmdParam = createUSBBuffer(usbCmd, paramVal);
+            (*cmdParam)[USB_REQ_HEADER_SIZE] = regAddr;
+
+            if(getRegisterData(usbCmd, &(cmdData[3]), (tokenPos - 3), &((*cmdParam)[USB_REQ_HEADER_SIZE + 1])) == EXEC_FAIL)
+            {
+                // Data bytes or count is invalid.
+                RELEASE_STR(*cmdParam);
+                RELEASE_STR(inCmd);
+                continue;
+            }
+
+            break;
+        }
+        else if(strcmp(cmdData[0], "scan") == 0)
+        {
+            // Probe all the slave addresses on the device.
+            if(batchBuffer != NULL)
+            {
+                // Bus scan is a complete set of transactions and cannot be part of a batch.
+                reportError(CMD_BATCH_UNSUPPORTED);
+                RELEASE_STR(inCmd);
+                continue;
+            }
+
+            if(tokenPos > 1)
+            {
+                // Parameters are not required for this command.
+                printWarningMsg(CMD_PARAM_IGNORE);
+            }
+
+            *cmdParam = createUSBBuffer(USB_CMD_I2C_SCAN, 0x00);
+            break;
         }
         else if(strcmp(cmdData[0], "output-voltage") == 0)
         {
@@ -389,7 +967,7 @@ unsigned char getCommand(unsigned char **cmdParam)
             if(tokenPos < 2)
             {
                 // Required paramaters are missing. WRITE-ADDRESS <ADDRESS | READ/WRITE>
-                printCommandError(CMD_MSG_PARAMETER_MISSING, cmdData[0]);
+                reportCommandError(CMD_MSG_PARAMETER_MISSING, cmdData[0]);
                 RELEASE_STR(inCmd);
                 continue;
             }
@@ -401,9 +979,7 @@ unsigned char getCommand(unsigned char **cmdParam)
                 continue;
             }
 
-            // Create HID feature buffer to send to the device.
-            *cmdParam = createUSBBuffer(USB_CMD_SET_VOLTAGE, paramVal); 
-            break; 
+            usbCmd = USB_CMD_SET_VOLTAGE;
         }
         else if(strcmp(cmdData[0], "reset") == 0)
         {
@@ -414,17 +990,190 @@ unsigned char getCommand(unsigned char **cmdParam)
                 printWarningMsg(CMD_PARAM_IGNORE);
             }
 
-            // Create HID feature buffer to send to the device.
-            *cmdParam = createUSBBuffer(USB_CMD_RESET, 0x00); 
+            usbCmd = USB_CMD_RESET;
+            paramVal = 0x00;
+        }
+        else if(strcmp(cmdData[0], "timeout") == 0)
+        {
+            // Set bus timeout of the device.
+            if(batchBuffer != NULL)
+            {
+                // Timeouts are session settings and cannot be part of a batch.
+                reportError(CMD_BATCH_UNSUPPORTED);
+                RELEASE_STR(inCmd);
+                continue;
+            }
+
+            if(tokenPos < 3)
+            {
+                // Required paramaters are missing. TIMEOUT <TYPE> <MILLISECONDS>
+                reportCommandError(CMD_MSG_PARAMETER_MISSING, cmdData[0]);
+                RELEASE_STR(inCmd);
+                continue;
+            }
+
+            if(getTimeout(&(cmdData[1]), &paramVal, &timeoutVal) == EXEC_FAIL)
+            {
+                // Parameter value is invalid or not specified.
+                RELEASE_STR(inCmd);
+                continue;
+            }
+
+            // Request format: HEADER | TIMEOUT (LSB) | TIMEOUT (MSB)
+            *cmdParam = createUSBBuffer(USB_CMD_SET_TIMEOUT, paramVal);
+            (*cmdParam)[USB_REQ_HEADER_SIZE] = timeoutVal & 0xFF;
+            (*cmdParam)[USB_REQ_HEADER_SIZE + 1] = (timeoutVal >> 8) & 0xFF;
+            break;
+        }
+        else if(strcmp(cmdData[0], "sample") == 0)
+        {
+            // Timer driven register sampling of the device.
+            if(batchBuffer != NULL)
+            {
+                // Sampling commands are device settings and cannot be part of a batch.
+                reportError(CMD_BATCH_UNSUPPORTED);
+                RELEASE_STR(inCmd);
+                continue;
+            }
+
+            if((tokenPos < 2) || (strcmp(cmdData[1], "read") == 0))
+            {
+                // Drain the sample frames buffered in the device. SAMPLE {READ}
+                *cmdParam = createUSBBuffer(USB_CMD_SAMPLE_READ, 0x00);
+            }
+            else if((strcmp(cmdData[1], "start") == 0) || (strcmp(cmdData[1], "stop") == 0))
+            {
+                // Start or stop the sampling timer. SAMPLE <START | STOP>
+                *cmdParam = createUSBBuffer(USB_CMD_SAMPLE_CONTROL, (cmdData[1][2] == 'a') ? 0x01 : 0x00);
+            }
+            else if(strcmp(cmdData[1], "config") == 0)
+            {
+                // Request format: HEADER | PERIOD (LSB) | PERIOD (MSB) | ADDRESS | REGISTER | LENGTH | ...
+                *cmdParam = createUSBBuffer(USB_CMD_SAMPLE_CONFIG, 0x00);
+                if(getSampleConfig(&(cmdData[2]), (tokenPos - 2), &((*cmdParam)[2]), &((*cmdParam)[USB_REQ_HEADER_SIZE])) == EXEC_FAIL)
+                {
+                    // Sampling list is invalid.
+                    RELEASE_STR(*cmdParam);
+                    RELEASE_STR(inCmd);
+                    continue;
+                }
+            }
+            else
+            {
+                // Unsupported sample operation.
+                reportError(CMD_PARAM_INVALID_SAMPLE);
+                RELEASE_STR(inCmd);
+                continue;
+            }
+
+            break;
+        }
+        else if(strcmp(cmdData[0], "stats") == 0)
+        {
+            // Performance counters of the device.
+            if(batchBuffer != NULL)
+            {
+                // Statistics are device queries and cannot be part of a batch.
+                reportError(CMD_BATCH_UNSUPPORTED);
+                RELEASE_STR(inCmd);
+                continue;
+            }
+
+            if((tokenPos >= 2) && (strcmp(cmdData[1], "reset") != 0))
+            {
+                // Unsupported stats operation.
+                reportError(CMD_PARAM_INVALID_STATS);
+                RELEASE_STR(inCmd);
+                continue;
+            }
+
+            // Read the counters, and clear them after the read if requested. STATS {RESET}
+            *cmdParam = createUSBBuffer(USB_CMD_GET_STATS, (tokenPos >= 2) ? 0x01 : 0x00);
+            break;
+        }
+        else if(strcmp(cmdData[0], "poll-mode") == 0)
+        {
+            // Set response polling strategy of the session.
+            if((tokenPos >= 2) && (getPollStrategy(&(cmdData[1]), &paramVal) == EXEC_SUCCESS))
+            {
+                setPollMode(paramVal);
+            }
+
+            // Show current polling strategy and poll count statistics.
+            showPollStatus();
+            RELEASE_STR(inCmd);
+            continue;
+        }
+        else if(strcmp(cmdData[0], "device") == 0)
+        {
+            // Select the device(s) which receive the commands of the session. DEVICE {TARGET}
+            if((tokenPos >= 2) && (getDeviceTarget(&(cmdData[1]), &targetVal) == EXEC_SUCCESS))
+            {
+                sessionTarget = targetVal;
+            }
+
+            // Show the list of devices and the current selection.
+            printDeviceList(deviceNames, deviceCount, sessionTarget);
+            RELEASE_STR(inCmd);
+            continue;
+        }
+        else if(strcmp(cmdData[0], "batch-begin") == 0)
+        {
+            // Start recording I2C operations into a batch.
+            if(batchBuffer != NULL)
+            {
+                printWarningMsg(CMD_BATCH_ACTIVE);
+            }
+            else
+            {
+                batchBuffer = createUSBBuffer(USB_CMD_BATCH, 0);
+            }
+
+            RELEASE_STR(inCmd);
+            continue;
+        }
+        else if(strcmp(cmdData[0], "batch-end") == 0)
+        {
+            // Send recorded I2C operations to the device as a single request.
+            if(batchBuffer == NULL)
+            {
+                reportError(CMD_BATCH_NOT_ACTIVE);
+                RELEASE_STR(inCmd);
+                continue;
+            }
+
+            if(batchBuffer[2] == 0)
+            {
+                // Nothing to execute, discard the empty batch.
+                printWarningMsg(CMD_BATCH_EMPTY);
+                RELEASE_STR(batchBuffer);
+                RELEASE_STR(inCmd);
+                continue;
+            }
+
+            *cmdParam = batchBuffer;
+            batchBuffer = NULL;
             break;
         }
         else
         {
             // Unknown command!
-            printCommandError(CMD_MSG_UNKNOWN, cmdData[0]);
+            reportCommandError(CMD_MSG_UNKNOWN, cmdData[0]);
             RELEASE_STR(inCmd);
             continue;
-        }        
+        }
+
+        if(batchBuffer != NULL)
+        {
+            // Batch is active, append the operation and continue for the next input.
+            appendBatchOperation(usbCmd, paramVal);
+            RELEASE_STR(inCmd);
+            continue;
+        }
+
+        // Create HID feature buffer to send to the device.
+        *cmdParam = createUSBBuffer(usbCmd, paramVal);
+        break;
     }
 
     // Release input buffer.
@@ -432,6 +1181,17 @@ unsigned char getCommand(unsigned char **cmdParam)
     {
         RELEASE_STR(inCmd);
     }
+    else if(*cmdParam == NULL)
+    {
+        // End of the input (or script), close the session.
+        returnStatus = CMD_STATUS_EXIT;
+    }
+
+    if((returnStatus == CMD_STATUS_EXIT) && (batchBuffer != NULL))
+    {
+        // Discard unfinished batch.
+        RELEASE_STR(batchBuffer);
+    }
 
     return returnStatus;
 }
\ No newline at end of file
@@ -25,10 +25,18 @@
 #ifndef I2C_TERMINAL_COMMOND_PROCESSOR
 #define I2C_TERMINAL_COMMOND_PROCESSOR
 
+#include <stdio.h>
+
 #define CMD_STATUS_OK   0
 #define CMD_STATUS_EXIT 1
 
-unsigned char *createUSBBuffer(unsigned char cmd, unsigned char data);
+void setCommandScript(const char *script);
+void setCommandFile(FILE *file);
+unsigned char isInteractive();
+unsigned int getCommandErrorCount();
+void setCommandDevices(const char **names, unsigned int count);
+unsigned int getCommandTarget();
+
 unsigned char getCommand(unsigned char **cmdParam);
 
 #endif /* I2C_TERMINAL_COMMOND_PROCESSOR */
\ No newline at end of file
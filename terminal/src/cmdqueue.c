@@ -0,0 +1,87 @@
+//----------------------------------------------------------------------------------
+// I2C Test Terminal - Lock-free Command Queue.
+//
+// Copyright (c) 2021 Dilshan R Jayakody [jayakody2000lk@gmail.com].
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//----------------------------------------------------------------------------------
+
+#include "cmdqueue.h"
+
+#include <stddef.h>
+
+void cmdQueueInit(struct CmdQueue *queue)
+{
+    atomic_init(&queue->head, 0);
+    atomic_init(&queue->tail, 0);
+
+    sem_init(&queue->usedSlots, 0, 0);
+    sem_init(&queue->freeSlots, 0, CMD_QUEUE_SIZE);
+}
+
+void cmdQueueRelease(struct CmdQueue *queue)
+{
+    sem_destroy(&queue->usedSlots);
+    sem_destroy(&queue->freeSlots);
+}
+
+struct CmdQueueEntry *cmdQueueReserve(struct CmdQueue *queue, unsigned char wait)
+{
+    unsigned int head;
+
+    // Producer side: wait (or fail) until a free slot is available in the queue.
+    if((wait ? sem_wait(&queue->freeSlots) : sem_trywait(&queue->freeSlots)) != 0)
+    {
+        return NULL;
+    }
+
+    // Only the producer updates the head, relaxed load is enough.
+    head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    return &queue->entries[head & (CMD_QUEUE_SIZE - 1)];
+}
+
+void cmdQueuePush(struct CmdQueue *queue)
+{
+    // Publish the reserved entry to the consumer.
+    atomic_fetch_add_explicit(&queue->head, 1, memory_order_release);
+    sem_post(&queue->usedSlots);
+}
+
+struct CmdQueueEntry *cmdQueuePeek(struct CmdQueue *queue, unsigned char wait)
+{
+    unsigned int tail;
+
+    // Consumer side: wait (or fail) until an entry is available in the queue.
+    if((wait ? sem_wait(&queue->usedSlots) : sem_trywait(&queue->usedSlots)) != 0)
+    {
+        return NULL;
+    }
+
+    // Pair with the release in cmdQueuePush to see the complete entry.
+    atomic_thread_fence(memory_order_acquire);
+    tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    return &queue->entries[tail & (CMD_QUEUE_SIZE - 1)];
+}
+
+void cmdQueuePop(struct CmdQueue *queue)
+{
+    // Return the consumed entry to the producer.
+    atomic_fetch_add_explicit(&queue->tail, 1, memory_order_release);
+    sem_post(&queue->freeSlots);
+}
\ No newline at end of file
@@ -0,0 +1,64 @@
+//----------------------------------------------------------------------------------
+// I2C Test Terminal - Lock-free Command Queue.
+//
+// Copyright (c) 2021 Dilshan R Jayakody [jayakody2000lk@gmail.com].
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//----------------------------------------------------------------------------------
+
+#ifndef I2C_TERMINAL_COMMAND_QUEUE
+#define I2C_TERMINAL_COMMAND_QUEUE
+
+#include <stdatomic.h>
+#include <semaphore.h>
+
+#include "common.h"
+
+// Number of entries in the queue, must be a power of 2.
+#define CMD_QUEUE_SIZE  16
+
+struct DevRequest;
+
+// Queue holds references to the requests, buffers of the request are owned by the caller.
+struct CmdQueueEntry
+{
+    struct DevRequest *devRequest;
+};
+
+// Single-producer / single-consumer ring. Indices are lock-free, semaphores are used 
+// only to sleep while the queue is empty (consumer) or full (producer).
+struct CmdQueue
+{
+    struct CmdQueueEntry entries[CMD_QUEUE_SIZE];
+    atomic_uint head;
+    atomic_uint tail;
+    sem_t usedSlots;
+    sem_t freeSlots;
+};
+
+void cmdQueueInit(struct CmdQueue *queue);
+void cmdQueueRelease(struct CmdQueue *queue);
+
+struct CmdQueueEntry *cmdQueueReserve(struct CmdQueue *queue, unsigned char wait);
+void cmdQueuePush(struct CmdQueue *queue);
+
+struct CmdQueueEntry *cmdQueuePeek(struct CmdQueue *queue, unsigned char wait);
+void cmdQueuePop(struct CmdQueue *queue);
+
+#endif /* I2C_TERMINAL_COMMAND_QUEUE */
\ No newline at end of file
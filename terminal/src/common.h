@@ -27,12 +27,6 @@
 
 typedef unsigned char EXEC_STATUS;
 
-struct UsbComData
-{
-    unsigned char* comData;
-    int deviceHandler;
-};
-
 #define EXEC_SUCCESS    0x00
 #define EXEC_FAIL       0xFF
 
@@ -49,19 +43,115 @@ struct UsbComData
 #define USB_CMD_SET_VOLTAGE     0x07
 #define USB_CMD_GET_VOLTAGE     0x08
 #define USB_CMD_RESET           0x09
+#define USB_CMD_BATCH           0x0A
+#define USB_CMD_I2C_READ_REG    0x0B
+#define USB_CMD_I2C_WRITE_REG   0x0C
+#define USB_CMD_SET_TIMEOUT     0x0D
+#define USB_CMD_I2C_SCAN        0x0E
+#define USB_CMD_I2C_READ_BULK   0x0F
+#define USB_CMD_I2C_WRITE_BULK  0x10
+#define USB_CMD_SAMPLE_CONFIG   0x11
+#define USB_CMD_SAMPLE_CONTROL  0x12
+#define USB_CMD_SAMPLE_READ     0x13
+#define USB_CMD_GET_STATS       0x14
 
 #define TWI_COM_SPEED_100   0   // 100kHz
 #define TWI_COM_SPEED_250   1   // 250kHz
 #define TWI_COM_SPEED_400   2   // 400kHz
 
-#define USB_SET_COMMAND_BUFFER_SIZE 64
-#define USB_GET_DATA_BUFFER_SIZE    64
+// HID feature report size (ref: usbHidReportDescriptor in firmware).
+#define USB_REPORT_SIZE             128
+
+// HIDRAW prefix the received feature report with the report number.
+#define USB_SET_COMMAND_BUFFER_SIZE USB_REPORT_SIZE
+#define USB_GET_DATA_BUFFER_SIZE    (USB_REPORT_SIZE + 1)
+
+// Request header: SIGNATURE | COMMAND | DATA0 | END SIGNATURE | TAG
+// Response header: SIGNATURE | COMMAND | STATUS | DATA0 | TAG
+// TAG is echoed back by the device to match the response with the request.
+#define USB_REQ_HEADER_SIZE     5
+#define USB_RESP_HEADER_SIZE    5
+
+// Completion record received over the interrupt-IN endpoint: SIGNATURE | COMMAND | STATUS | DATA0 | TAG
+#define USB_EVENT_RECORD_SIZE   8
+
+// Command slots of the device, completed results hold the slot until collected (ref: CMD_QUEUE_SIZE in firmware).
+#define DEV_QUEUE_SIZE  4
+
+// Each batch operation is a COMMAND | DATA pair in the request and a STATUS | DATA pair in the response.
+#define BATCH_MAX_OPS   ((USB_REPORT_SIZE - USB_REQ_HEADER_SIZE) / 2)
+
+// Register commands carry REGISTER | COUNT before the data bytes.
+#define REG_MAX_READ_COUNT  (USB_REPORT_SIZE - USB_RESP_HEADER_SIZE)
+#define REG_MAX_WRITE_COUNT (USB_REPORT_SIZE - USB_REQ_HEADER_SIZE - 2)
+
+// Bulk read response and bulk write request carry the data bytes after the header.
+#define BULK_MAX_READ_COUNT     (USB_REPORT_SIZE - USB_RESP_HEADER_SIZE)
+#define BULK_MAX_WRITE_COUNT    (USB_REPORT_SIZE - USB_REQ_HEADER_SIZE)
+
+// Bus scan response carries the presence bitmap and 2-bit status of each address (ref: i2ctester.h in firmware).
+#define SCAN_FIRST_ADDR     0x08
+#define SCAN_LAST_ADDR      0x77
+#define SCAN_BITMAP_SIZE    16
+#define SCAN_STATUS_SIZE    32
+
+// Register sampling list and frame limits (ref: sampler.h in firmware).
+// Configuration: PERIOD (LSB) | PERIOD (MSB) | ADDRESS | REGISTER | LENGTH | ...
+// Sample block: MISSED | FRAME SIZE | FRAMES..., frame: SEQUENCE | STATUS | DATA...
+#define SAMPLE_MAX_ENTRIES      8
+#define SAMPLE_CONFIG_HEADER    2
+#define SAMPLE_ENTRY_SIZE       3
+#define SAMPLE_BLOCK_HEADER     2
+#define SAMPLE_FRAME_HEADER     2
+#define SAMPLE_MAX_FRAME        32
+#define SAMPLE_MAX_PERIOD_MS    60000
+
+// Performance counters of the device (ref: i2ctester.h in firmware), multi-byte values are LSB first:
+// USB POLLS (32) | WAIT ITERATIONS (32) | MAX POLL GAP (16) | TIMEOUTS (16) | BUS BUSY (16) | ARBITRATION LOST (16) |
+// REJECTED (16) | COMMAND COUNT (16) of each opcode from 0x01 to STATS_OPCODE_COUNT.
+#define STATS_OPCODE_COUNT  USB_CMD_GET_STATS
+#define STATS_HEADER_SIZE   18
+#define STATS_SIZE          (STATS_HEADER_SIZE + (STATS_OPCODE_COUNT * 2))
+
+// Poll gap is reported in Timer1 ticks of the device (1024 / 16MHz).
+#define STATS_TICK_US       64
+
+#define SCAN_STATUS_NONE    0x00
+#define SCAN_STATUS_ACK     0x01
+#define SCAN_STATUS_TIMEOUT 0x02
+#define SCAN_STATUS_ERROR   0x03
+
+// TWI status codes reported by the device (ref: util/twi.h of avr-libc).
+#define TWI_STATUS_START        0x08
+#define TWI_STATUS_REP_START    0x10
+#define TWI_STATUS_MT_SLA_ACK   0x18
+#define TWI_STATUS_MT_SLA_NACK  0x20
+#define TWI_STATUS_MT_DATA_ACK  0x28
+#define TWI_STATUS_MT_DATA_NACK 0x30
+#define TWI_STATUS_MR_SLA_ACK   0x40
+#define TWI_STATUS_MR_SLA_NACK  0x48
+#define TWI_STATUS_MR_DATA_ACK  0x50
+#define TWI_STATUS_MR_DATA_NACK 0x58
+#define TWI_STATUS_NO_INFO      0xF8
 
 #define RET_SUCCESS         0x00
 #define RET_PENDING         0x01
 #define RET_UNKNOWN         0x02
+#define RET_QUEUE_FULL      0xFD
+#define RET_BUS_BUSY_FAIL   0xFE
 #define RET_TIMEOUT_FAIL    0xFF
 
+// Bus timeout selectors (ref: i2cdrv.h in firmware).
+#define I2C_TIMEOUT_START   0
+#define I2C_TIMEOUT_STRETCH 1
+#define I2C_TIMEOUT_COMMAND 2
+#define I2C_TIMEOUT_BATCH   3
+
+#define I2C_TIMEOUT_MAX_MS  4000
+
+// Maximum number of devices driven by a single terminal session (bit mask of the command target).
+#define MAX_TERM_DEVICES    8
+
 #define I2C_OUTPUT_5V   0x01
 #define I2C_OUTPUT_3V3  0x02
 
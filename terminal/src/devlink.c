@@ -0,0 +1,479 @@
+//----------------------------------------------------------------------------------
+// I2C Test Terminal - Device Link (HIDRAW Transport).
+//
+// Copyright (c) 2021 Dilshan R Jayakody [jayakody2000lk@gmail.com].
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//----------------------------------------------------------------------------------
+
+#include "devlink.h"
+#include "usbproto.h"
+#include "pollctl.h"
+
+#include <linux/types.h>
+#include <linux/input.h>
+#include <linux/hidraw.h>
+
+#include <sys/ioctl.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+EXEC_STATUS findTerminalDevice(const char *serialNumber, char **hidRawPath)
+{
+    struct udev *udev;
+    EXEC_STATUS status;
+
+    // Try to find the I2C terminal device on udev. If available get the device path.
+    udev = udev_new();
+    if(udev == NULL)
+    {
+        *hidRawPath = NULL;
+        return EXEC_FAIL;
+    }
+
+    status = getTerminalDevicePath(udev, serialNumber, hidRawPath);
+    udev_unref(udev);
+
+    return status;
+}
+
+int openTerminalDevice(const char *hidRawPath)
+{
+    // Open USB device for communication, completion records are read without blocking.
+    return open(hidRawPath, (O_RDWR | O_NONBLOCK));
+}
+
+void closeTerminalDevice(int deviceHandler)
+{
+    close(deviceHandler);
+}
+
+EXEC_STATUS drainDeviceResults(int deviceHandler)
+{
+    unsigned char response[USB_GET_DATA_BUFFER_SIZE];
+    struct timespec req, rem;
+    unsigned int pollPos;
+
+    // Completed results occupy the device command slots until those are collected with the feature report, so
+    // collect and discard the results (and the completion records) of the previous session.
+    for(pollPos = 0; pollPos < DEV_DRAIN_POLL_LIMIT; pollPos++)
+    {
+        memset(response, 0, USB_GET_DATA_BUFFER_SIZE);
+        if(ioctl(deviceHandler, HIDIOCGFEATURE(USB_GET_DATA_BUFFER_SIZE), response) < 0)
+        {
+            return EXEC_FAIL;
+        }
+
+        if((response[1] == SYS_SIGNATURE) && (response[3] == RET_PENDING))
+        {
+            if(response[2] == USB_CMD_NONE)
+            {
+                // Device command queue is empty.
+                flushEvents(deviceHandler);
+                return EXEC_SUCCESS;
+            }
+
+            // Command of the previous session is still in execution, wait until it completes.
+            req.tv_sec = 0;
+            req.tv_nsec = POLL_BACKOFF_MAX_US * 1000;
+            nanosleep(&req, &rem);
+        }
+    }
+
+    // Device is still busy with the commands of the previous session.
+    flushEvents(deviceHandler);
+    return EXEC_FAIL;
+}
+
+EXEC_STATUS postDeviceRequest(int deviceHandler, const unsigned char *request)
+{
+    // Send specified USB data buffer to the device.
+    if(ioctl(deviceHandler, HIDIOCSFEATURE(getUSBBufferLength(request)), request) < 0)
+    {
+        // Communication failure has occur while setting up the feature report.
+        return EXEC_FAIL;
+    }
+
+    return EXEC_SUCCESS;
+}
+
+static struct DevLinkSlot *findLinkSlot(struct DevLink *link, unsigned char cmd, unsigned char tag)
+{
+    unsigned int slotPos;
+
+    // Only the requests which are still waiting for the response are matched.
+    for(slotPos = 0; slotPos < DEV_QUEUE_SIZE; slotPos++)
+    {
+        if((link->slots[slotPos].request != NULL) && (!link->slots[slotPos].responseReady) && 
+            (link->slots[slotPos].request[1] == cmd) && (link->slots[slotPos].request[4] == tag))
+        {
+            return &link->slots[slotPos];
+        }
+    }
+
+    return NULL;
+}
+
+static unsigned char isLinkResultReady(const struct DevLink *link)
+{
+    unsigned int slotPos;
+
+    for(slotPos = 0; slotPos < DEV_QUEUE_SIZE; slotPos++)
+    {
+        if((link->slots[slotPos].request != NULL) && link->slots[slotPos].eventReceived && (!link->slots[slotPos].responseReady))
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static EXEC_STATUS resendLinkRequest(int deviceHandler, struct DevLinkSlot *slot, struct PollState *pollState)
+{
+    // Device command queue is full, apply back-pressure and send the request again.
+    pollWait(pollState);
+    pollState->resendCount++;
+    slot->eventReceived = 0;
+
+    return postDeviceRequest(deviceHandler, slot->request);
+}
+
+static EXEC_STATUS pollDeviceLink(int deviceHandler, struct DevLink *link, struct PollState *pollState)
+{
+    unsigned char eventRecord[USB_EVENT_RECORD_SIZE];
+    unsigned char response[USB_GET_DATA_BUFFER_SIZE];
+    struct DevLinkSlot *slot;
+    unsigned int slotPos;
+
+    // Wait for the completion record, unless a result is already known to be ready on the device.
+    if(isEventPollMode() && (!isLinkResultReady(link)) && (pollWaitEvent(pollState, deviceHandler, eventRecord) == EXEC_SUCCESS))
+    {
+        slot = (eventRecord[0] == SYS_SIGNATURE) ? findLinkSlot(link, eventRecord[1], eventRecord[4]) : NULL;
+        if((slot == NULL) || (eventRecord[2] == RET_PENDING))
+        {
+            // Completion record is not related to the requests in flight, wait for the next record.
+            return EXEC_SUCCESS;
+        }
+
+        if(eventRecord[2] == RET_QUEUE_FULL)
+        {
+            return resendLinkRequest(deviceHandler, slot, pollState);
+        }
+
+        // Result is ready on the device. It is always collected with the feature report, which releases the
+        // queue slot of the device.
+        slot->eventReceived = 1;
+    }
+
+    // Get response from the device as feature report. Device returns the oldest completed result.
+    memset(response, 0, USB_GET_DATA_BUFFER_SIZE);
+    if(ioctl(deviceHandler, HIDIOCGFEATURE(USB_GET_DATA_BUFFER_SIZE), response) < 0)
+    {
+        // Communication failure has occur while reading the feature report.
+        return EXEC_FAIL;
+    }
+
+    pollState->pollCount++;
+    if((response[1] != SYS_SIGNATURE) || (response[3] == RET_PENDING))
+    {
+        if((response[1] == SYS_SIGNATURE) && (response[2] == USB_CMD_NONE))
+        {
+            // Device command queue is empty, requests in flight are rejected without a record (device keeps only
+            // the last rejection). Send those again.
+            for(slotPos = 0; slotPos < DEV_QUEUE_SIZE; slotPos++)
+            {
+                slot = &link->slots[slotPos];
+                if((slot->request != NULL) && (!slot->responseReady) && (resendLinkRequest(deviceHandler, slot, pollState) == EXEC_FAIL))
+                {
+                    return EXEC_FAIL;
+                }
+            }
+        }
+        else if(!isEventPollMode())
+        {
+            // Wait thread based on the session polling strategy to get the next feature report.
+            pollWait(pollState);
+        }
+
+        return EXEC_SUCCESS;
+    }
+
+    slot = findLinkSlot(link, response[2], response[5]);
+    if(slot == NULL)
+    {
+        // Result of a request which is already abandoned by the host.
+        return EXEC_SUCCESS;
+    }
+
+    if(response[3] == RET_QUEUE_FULL)
+    {
+        return resendLinkRequest(deviceHandler, slot, pollState);
+    }
+
+    // Device respond with data / status, keep it until the owner of the request waits for it.
+    memcpy(slot->response, response, USB_GET_DATA_BUFFER_SIZE);
+    slot->responseReady = 1;
+
+    return EXEC_SUCCESS;
+}
+
+static EXEC_STATUS hidrawOpen(struct Transport *transport, const char *target)
+{
+    transport->deviceHandler = openTerminalDevice(target);
+    if(transport->deviceHandler < 0)
+    {
+        return EXEC_FAIL;
+    }
+
+    transport->context = calloc(1, sizeof(struct DevLink));
+    if((transport->context == NULL) || (drainDeviceResults(transport->deviceHandler) == EXEC_FAIL))
+    {
+        // Device slots are not available for this session.
+        free(transport->context);
+        transport->context = NULL;
+        closeTerminalDevice(transport->deviceHandler);
+        transport->deviceHandler = -1;
+        return EXEC_FAIL;
+    }
+
+    return EXEC_SUCCESS;
+}
+
+static EXEC_STATUS hidrawSubmit(struct Transport *transport, const unsigned char *request)
+{
+    struct DevLink *link = (struct DevLink *)transport->context;
+    struct DevLinkSlot *slot = NULL;
+    unsigned int slotPos;
+
+    // Up to DEV_QUEUE_SIZE requests are in flight, same as the command slots of the device.
+    for(slotPos = 0; (slotPos < DEV_QUEUE_SIZE) && (slot == NULL); slotPos++)
+    {
+        slot = (link->slots[slotPos].request == NULL) ? &link->slots[slotPos] : NULL;
+    }
+
+    if(slot == NULL)
+    {
+        return EXEC_FAIL;
+    }
+
+    // Completion records of the other requests in flight are still relevant, those are not flushed.
+    if(postDeviceRequest(transport->deviceHandler, request) == EXEC_FAIL)
+    {
+        return EXEC_FAIL;
+    }
+
+    slot->request = request;
+    slot->eventReceived = 0;
+    slot->responseReady = 0;
+
+    transport->transferCount++;
+    return EXEC_SUCCESS;
+}
+
+static EXEC_STATUS hidrawWait(struct Transport *transport, const unsigned char *request, unsigned char *response, unsigned int *pollCount)
+{
+    struct DevLink *link = (struct DevLink *)transport->context;
+    struct DevLinkSlot *slot = NULL;
+    struct PollState pollState;
+    EXEC_STATUS status = EXEC_SUCCESS;
+    unsigned int slotPos;
+
+    for(slotPos = 0; (slotPos < DEV_QUEUE_SIZE) && (slot == NULL); slotPos++)
+    {
+        slot = (link->slots[slotPos].request == request) ? &link->slots[slotPos] : NULL;
+    }
+
+    if(slot == NULL)
+    {
+        // Request is not submitted over this link.
+        return EXEC_FAIL;
+    }
+
+    // Results of the other requests in flight are collected into their slots while waiting for this one.
+    pollBegin(&pollState);
+    while((!slot->responseReady) && (status == EXEC_SUCCESS))
+    {
+        status = pollDeviceLink(transport->deviceHandler, link, &pollState);
+    }
+
+    if(status == EXEC_SUCCESS)
+    {
+        memcpy(response, slot->response, USB_GET_DATA_BUFFER_SIZE);
+        pollEnd(&pollState);
+    }
+
+    slot->request = NULL;
+
+    // Each feature report, completion record and resend is a separate USB transfer.
+    transport->transferCount += pollState.pollCount + pollState.resendCount;
+    if(pollCount != NULL)
+    {
+        *pollCount = pollState.pollCount;
+    }
+
+    return status;
+}
+
+static void hidrawClose(struct Transport *transport)
+{
+    closeTerminalDevice(transport->deviceHandler);
+    free(transport->context);
+    transport->context = NULL;
+    transport->deviceHandler = -1;
+}
+
+// HIDRAW backend, completion is detected with the session polling strategy (ref: pollctl.h).
+const struct TransportOps hidrawTransportOps = {TRANSPORT_HIDRAW, (TRANSPORT_CAP_EVENTS | TRANSPORT_CAP_QUEUE | TRANSPORT_CAP_HARDWARE), 
+    hidrawOpen, hidrawSubmit, hidrawWait, hidrawClose};
+
+EXEC_STATUS findTerminalDevices(const char *serialNumber, struct TermDeviceInfo *devices, unsigned int maxDevices, unsigned int *deviceCount)
+{
+    struct udev *udev;
+    EXEC_STATUS status;
+
+    // Find all the I2C terminal devices (with the specified serial number) on udev.
+    *deviceCount = 0;
+    udev = udev_new();
+    if(udev == NULL)
+    {
+        return EXEC_FAIL;
+    }
+
+    status = getTerminalDevices(udev, serialNumber, devices, maxDevices, deviceCount);
+    udev_unref(udev);
+
+    return status;
+}
+
+void releaseTerminalDevices(struct TermDeviceInfo *devices, unsigned int deviceCount)
+{
+    unsigned int devPos;
+
+    for(devPos = 0; devPos < deviceCount; devPos++)
+    {
+        free(devices[devPos].hidRawPath);
+        free(devices[devPos].serialNumber);
+
+        devices[devPos].hidRawPath = NULL;
+        devices[devPos].serialNumber = NULL;
+    }
+}
+
+EXEC_STATUS getTerminalDevicePath(struct udev *udev, const char *serialNumber, char **hidRawPath)
+{
+    struct TermDeviceInfo device;
+    unsigned int deviceCount;
+
+    *hidRawPath = NULL;
+    if(getTerminalDevices(udev, serialNumber, &device, 1, &deviceCount) == EXEC_FAIL)
+    {
+        return EXEC_FAIL;
+    }
+
+    // Only the device path is required by the caller.
+    *hidRawPath = device.hidRawPath;
+    free(device.serialNumber);
+
+    return EXEC_SUCCESS;
+}
+
+EXEC_STATUS getTerminalDevices(struct udev *udev, const char *serialNumber, struct TermDeviceInfo *devices, unsigned int maxDevices, unsigned int *deviceCount)
+{
+    struct udev_enumerate *hidEnum, *rawEnum;
+    struct udev_list_entry *hidEntry, *rawEntry;
+    struct udev_device *hidDev, *rawDev;
+    const char *devPath, *devSerial;
+    char hidId[32];
+
+    *deviceCount = 0;
+
+    // Let udev match the HID devices of the terminal by bus, VID and PID. Both the USB device and the
+    // UHID based emulator are exposed with the same HID_ID (BUS:VENDOR:PRODUCT).
+    snprintf(hidId, sizeof(hidId), "%04X:%08X:%08X", BUS_USB, I2C_TERMINAL_DEV_VID, I2C_TERMINAL_DEV_PID);
+
+    hidEnum = udev_enumerate_new(udev);
+    udev_enumerate_add_match_subsystem(hidEnum, "hid");
+    udev_enumerate_add_match_property(hidEnum, "HID_ID", hidId);
+    udev_enumerate_scan_devices(hidEnum);
+
+    // HID-RAW node is searched only under the matching HID devices.
+    udev_list_entry_foreach(hidEntry, udev_enumerate_get_list_entry(hidEnum))
+    {
+        if(*deviceCount >= maxDevices)
+        {
+            break;
+        }
+
+        hidDev = udev_device_new_from_syspath(udev, udev_list_entry_get_name(hidEntry));
+        if(hidDev == NULL)
+        {
+            continue;
+        }
+
+        // Serial number of the USB device (or the emulator) is reported as HID_UNIQ.
+        devSerial = udev_device_get_property_value(hidDev, "HID_UNIQ");
+        devSerial = ((devSerial != NULL) && (*devSerial != 0)) ? devSerial : NULL;
+
+        if(serialNumber && ((devSerial == NULL) || (strcmp(devSerial, serialNumber) != 0)))
+        {
+            // udev ORs property matches together, so the serial number is compared here.
+            udev_device_unref(hidDev);
+            continue;
+        }
+
+        rawEnum = udev_enumerate_new(udev);
+        udev_enumerate_add_match_subsystem(rawEnum, "hidraw");
+        udev_enumerate_add_match_parent(rawEnum, hidDev);
+        udev_enumerate_scan_devices(rawEnum);
+
+        rawEntry = udev_enumerate_get_list_entry(rawEnum);
+        if(rawEntry)
+        {
+            rawDev = udev_device_new_from_syspath(udev, udev_list_entry_get_name(rawEntry));
+            devPath = (rawDev) ? udev_device_get_devnode(rawDev) : NULL;
+
+            if(devPath)
+            {
+                // Copy HID-RAW device path and serial number into the device list.
+                devices[*deviceCount].hidRawPath = strdup(devPath);
+                devices[*deviceCount].serialNumber = (devSerial) ? strdup(devSerial) : NULL;
+                (*deviceCount)++;
+            }
+
+            if(rawDev)
+            {
+                udev_device_unref(rawDev);
+            }
+        }
+
+        udev_enumerate_unref(rawEnum);
+        udev_device_unref(hidDev);
+    }
+
+    // Cleanup allocated data structures.
+    udev_enumerate_unref(hidEnum);
+
+    return (*deviceCount > 0) ? EXEC_SUCCESS : EXEC_FAIL;
+}
\ No newline at end of file
@@ -0,0 +1,74 @@
+//----------------------------------------------------------------------------------
+// I2C Test Terminal - Device Link (HIDRAW Transport).
+//
+// Copyright (c) 2021 Dilshan R Jayakody [jayakody2000lk@gmail.com].
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//----------------------------------------------------------------------------------
+
+#ifndef I2C_TERMINAL_DEVICE_LINK
+#define I2C_TERMINAL_DEVICE_LINK
+
+#include <libudev.h>
+
+#include "common.h"
+#include "transport.h"
+
+#define I2C_TERMINAL_DEV_VID    0x16C0
+#define I2C_TERMINAL_DEV_PID    0x1231
+
+// Feature report polls used to collect the results left on the device by the previous session.
+#define DEV_DRAIN_POLL_LIMIT    256
+
+// Request in flight on the HIDRAW link. Completion records and feature reports are matched with the
+// request by the command and the tag, request buffer must be valid until the response is collected.
+struct DevLinkSlot
+{
+    const unsigned char *request;   // NULL if the slot is free.
+    unsigned char eventReceived;
+    unsigned char responseReady;
+    unsigned char response[USB_GET_DATA_BUFFER_SIZE];
+};
+
+struct DevLink
+{
+    struct DevLinkSlot slots[DEV_QUEUE_SIZE];
+};
+
+// Device entry found on udev, both strings are allocated and released with releaseTerminalDevices.
+struct TermDeviceInfo
+{
+    char *hidRawPath;
+    char *serialNumber;
+};
+
+EXEC_STATUS findTerminalDevice(const char *serialNumber, char **hidRawPath);
+EXEC_STATUS findTerminalDevices(const char *serialNumber, struct TermDeviceInfo *devices, unsigned int maxDevices, unsigned int *deviceCount);
+void releaseTerminalDevices(struct TermDeviceInfo *devices, unsigned int deviceCount);
+int openTerminalDevice(const char *hidRawPath);
+void closeTerminalDevice(int deviceHandler);
+EXEC_STATUS drainDeviceResults(int deviceHandler);
+
+EXEC_STATUS getTerminalDevicePath(struct udev *udev, const char *serialNumber, char **hidRawPath);
+EXEC_STATUS getTerminalDevices(struct udev *udev, const char *serialNumber, struct TermDeviceInfo *devices, unsigned int maxDevices, unsigned int *deviceCount);
+EXEC_STATUS postDeviceRequest(int deviceHandler, const unsigned char *request);
+
+extern const struct TransportOps hidrawTransportOps;
+
+#endif /* I2C_TERMINAL_DEVICE_LINK */
\ No newline at end of file
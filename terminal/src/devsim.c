@@ -0,0 +1,1104 @@
+//----------------------------------------------------------------------------------
+// I2C Test Terminal - In-Process Device Simulator.
+//
+// Copyright (c) 2021 Dilshan R Jayakody [jayakody2000lk@gmail.com].
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//----------------------------------------------------------------------------------
+
+#include "devsim.h"
+
+#include <time.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+// Single message of a simulated transaction (ref: struct I2CMessage in firmware).
+struct SimMessage
+{
+    unsigned char addr;
+    unsigned char flags;
+    unsigned char length;
+    unsigned char done;
+    unsigned char *data;
+};
+
+static unsigned char eepromAddress(struct SimSlave *slave, unsigned char addr, unsigned char read)
+{
+    // Low bits of the slave address select the 256 byte block of the small EEPROMs (24C04 - 24C16).
+    slave->block = addr & slave->addrMask;
+    slave->addrPhase = 0;
+    slave->addrLatch = 0;
+
+    if(read && (slave->addrBytes == 1))
+    {
+        // Current address read continues in the selected block.
+        slave->pointer = ((slave->block << 8) | (slave->pointer & 0xFF)) & (slave->memorySize - 1);
+    }
+
+    return 1;
+}
+
+static unsigned char eepromWrite(struct SimSlave *slave, unsigned char data)
+{
+    if(slave->addrPhase < slave->addrBytes)
+    {
+        // Memory address: 1 byte (24C01 - 24C16) or 2 bytes (24C32 and above), MSB first.
+        slave->addrLatch = (slave->addrLatch << 8) | data;
+        if(++slave->addrPhase == slave->addrBytes)
+        {
+            slave->pointer = ((slave->addrBytes == 1) ? ((slave->block << 8) | slave->addrLatch) : slave->addrLatch) & (slave->memorySize - 1);
+        }
+
+        return 1;
+    }
+
+    // Page write, address counter rolls over within the current page.
+    slave->memory[slave->pointer] = data;
+    slave->pointer = (slave->pointer & ~(slave->pageSize - 1)) | ((slave->pointer + 1) & (slave->pageSize - 1));
+    return 1;
+}
+
+static unsigned char eepromRead(struct SimSlave *slave)
+{
+    unsigned char data = slave->memory[slave->pointer];
+
+    // Sequential read rolls over to the beginning of the memory.
+    slave->pointer = (slave->pointer + 1) & (slave->memorySize - 1);
+    return data;
+}
+
+static void eepromStop(struct SimSlave *slave)
+{
+    // Write cycle completes immediately, acknowledge polling is not required.
+    slave->addrPhase = 0;
+}
+
+static void eepromReset(struct SimSlave *slave)
+{
+    // Memory content is kept over the power cycle.
+    slave->addrPhase = 0;
+    slave->pointer = 0;
+}
+
+static void sensorReset(struct SimSlave *slave)
+{
+    memset(slave->memory, 0, slave->memorySize);
+    slave->memory[SIM_SENSOR_ID_REG] = SIM_SENSOR_ID;
+    slave->addrPhase = 0;
+    slave->pointer = 0;
+}
+
+static unsigned char sensorAddress(struct SimSlave *slave, unsigned char addr, unsigned char read)
+{
+    slave->addrPhase = 0;
+
+    if(read)
+    {
+        // Counter register shows a new value in each read transaction.
+        slave->memory[SIM_SENSOR_COUNT_REG]++;
+    }
+
+    return 1;
+}
+
+static unsigned char sensorWrite(struct SimSlave *slave, unsigned char data)
+{
+    if(slave->addrPhase == 0)
+    {
+        // First byte of the write selects the register.
+        slave->pointer = data;
+        slave->addrPhase = 1;
+        return 1;
+    }
+
+    if(slave->pointer != SIM_SENSOR_ID_REG)
+    {
+        // Identification register is read-only, write is acknowledged and ignored.
+        slave->memory[slave->pointer] = data;
+    }
+
+    slave->pointer = (slave->pointer + 1) & (SIM_SENSOR_REGISTERS - 1);
+    return 1;
+}
+
+static unsigned char sensorRead(struct SimSlave *slave)
+{
+    unsigned char data = slave->memory[slave->pointer];
+
+    slave->pointer = (slave->pointer + 1) & (SIM_SENSOR_REGISTERS - 1);
+    return data;
+}
+
+static void sensorStop(struct SimSlave *slave)
+{
+    slave->addrPhase = 0;
+}
+
+static unsigned char nackAddress(struct SimSlave *slave, unsigned char addr, unsigned char read)
+{
+    return 0;
+}
+
+static unsigned char nackDataAddress(struct SimSlave *slave, unsigned char addr, unsigned char read)
+{
+    return 1;
+}
+
+static unsigned char nackWrite(struct SimSlave *slave, unsigned char data)
+{
+    return 0;
+}
+
+static unsigned char nackRead(struct SimSlave *slave)
+{
+    // Slave does not drive SDA, pull-up returns all ones.
+    return 0xFF;
+}
+
+static const struct SimSlaveOps eepromOps = {eepromAddress, eepromWrite, eepromRead, eepromStop, eepromReset};
+static const struct SimSlaveOps sensorOps = {sensorAddress, sensorWrite, sensorRead, sensorStop, sensorReset};
+static const struct SimSlaveOps nackOps = {nackAddress, nackWrite, nackRead, NULL, NULL};
+static const struct SimSlaveOps nackDataOps = {nackDataAddress, nackWrite, nackRead, NULL, NULL};
+
+struct SimDevice *createSimDevice()
+{
+    struct SimDevice *simDevice = calloc(1, sizeof(struct SimDevice));
+
+    if(simDevice != NULL)
+    {
+        // Power-on state of the firmware.
+        simDevice->busStatus = TWI_STATUS_NO_INFO;
+        simDevice->outputVoltage = I2C_OUTPUT_3V3;
+    }
+
+    return simDevice;
+}
+
+void releaseSimDevice(struct SimDevice *simDevice)
+{
+    unsigned int slavePos;
+
+    if(simDevice == NULL)
+    {
+        return;
+    }
+
+    for(slavePos = 0; slavePos < simDevice->slaveCount; slavePos++)
+    {
+        free(simDevice->slaves[slavePos].memory);
+    }
+
+    free(simDevice);
+}
+
+static struct SimSlave *findSimSlave(struct SimDevice *simDevice, unsigned char addr)
+{
+    unsigned int slavePos;
+
+    for(slavePos = 0; slavePos < simDevice->slaveCount; slavePos++)
+    {
+        if((addr & ~simDevice->slaves[slavePos].addrMask) == simDevice->slaves[slavePos].addr)
+        {
+            return &simDevice->slaves[slavePos];
+        }
+    }
+
+    return NULL;
+}
+
+static struct SimSlave *reserveSimSlave(struct SimDevice *simDevice, unsigned char addr, unsigned char addrMask)
+{
+    struct SimSlave *slave;
+    unsigned int addrPos;
+
+    if((simDevice->slaveCount >= SIM_MAX_SLAVES) || (addr > 0x7F) || (addr & addrMask))
+    {
+        // Slave list is full or the address is not aligned with the block select bits.
+        return NULL;
+    }
+
+    for(addrPos = 0; addrPos <= addrMask; addrPos++)
+    {
+        if(findSimSlave(simDevice, addr | addrPos) != NULL)
+        {
+            // Address is already used by another slave.
+            return NULL;
+        }
+    }
+
+    slave = &simDevice->slaves[simDevice->slaveCount];
+    memset(slave, 0, sizeof(struct SimSlave));
+    slave->addr = addr;
+    slave->addrMask = addrMask;
+
+    return slave;
+}
+
+EXEC_STATUS addSimSlave(struct SimDevice *simDevice, unsigned char type, unsigned char addr, unsigned int size)
+{
+    struct SimSlave *slave;
+    unsigned char addrMask = 0;
+
+    if(type == SIM_SLAVE_EEPROM)
+    {
+        if((size < 128) || (size > 65536) || (size & (size - 1)))
+        {
+            // 24Cxx memory size is a power of two between 128 bytes (24C01) and 64KB (24C512).
+            return EXEC_FAIL;
+        }
+
+        // 24C04 - 24C16 use the low bits of the slave address as the block select bits.
+        addrMask = ((size > 256) && (size <= 2048)) ? (unsigned char)((size >> 8) - 1) : 0;
+    }
+
+    slave = reserveSimSlave(simDevice, addr, addrMask);
+    if(slave == NULL)
+    {
+        return EXEC_FAIL;
+    }
+
+    switch(type)
+    {
+    case SIM_SLAVE_EEPROM:
+        slave->ops = &eepromOps;
+        slave->memorySize = size;
+        slave->addrBytes = (size > 2048) ? 2 : 1;
+        slave->pageSize = (size <= 256) ? 8 : ((size <= 2048) ? 16 : ((size <= 8192) ? 32 : ((size <= 32768) ? 64 : 128)));
+        break;
+    case SIM_SLAVE_SENSOR:
+        slave->ops = &sensorOps;
+        slave->memorySize = SIM_SENSOR_REGISTERS;
+        break;
+    case SIM_SLAVE_NACK:
+        slave->ops = &nackOps;
+        break;
+    case SIM_SLAVE_NACK_DATA:
+        slave->ops = &nackDataOps;
+        break;
+    default:
+        // Unknown slave type.
+        return EXEC_FAIL;
+    }
+
+    if(slave->memorySize > 0)
+    {
+        slave->memory = malloc(slave->memorySize);
+        if(slave->memory == NULL)
+        {
+            return EXEC_FAIL;
+        }
+
+        // Erased EEPROM contains 0xFF in all the locations.
+        memset(slave->memory, 0xFF, slave->memorySize);
+        if(slave->ops->reset != NULL)
+        {
+            slave->ops->reset(slave);
+        }
+    }
+
+    simDevice->slaveCount++;
+    return EXEC_SUCCESS;
+}
+
+EXEC_STATUS addSimCustomSlave(struct SimDevice *simDevice, unsigned char addr, const struct SimSlaveOps *ops, void *context)
+{
+    struct SimSlave *slave;
+
+    if((ops == NULL) || (ops->address == NULL) || (ops->write == NULL) || (ops->read == NULL))
+    {
+        // Address, write and read events are mandatory.
+        return EXEC_FAIL;
+    }
+
+    slave = reserveSimSlave(simDevice, addr, 0);
+    if(slave == NULL)
+    {
+        return EXEC_FAIL;
+    }
+
+    slave->ops = ops;
+    slave->context = context;
+    simDevice->slaveCount++;
+
+    return EXEC_SUCCESS;
+}
+
+EXEC_STATUS addSimSlaves(struct SimDevice *simDevice, const char *spec)
+{
+    static const char *typeNames[] = {"eeprom", "sensor", "nack", "nack-data"};
+    const char *entry, *separator;
+    char *endPtr;
+    unsigned char type;
+    unsigned long addr, size;
+    size_t nameLength;
+
+    // Slave list format: TYPE@ADDRESS[:SIZE], TYPE@ADDRESS[:SIZE], ...
+    for(entry = spec; *entry != 0; entry = (*separator == ',') ? (separator + 1) : separator)
+    {
+        separator = strchr(entry, '@');
+        if(separator == NULL)
+        {
+            return EXEC_FAIL;
+        }
+
+        nameLength = separator - entry;
+        for(type = 0; type < (sizeof(typeNames) / sizeof(typeNames[0])); type++)
+        {
+            if((strlen(typeNames[type]) == nameLength) && (strncmp(entry, typeNames[type], nameLength) == 0))
+            {
+                break;
+            }
+        }
+
+        addr = strtoul(separator + 1, &endPtr, 0);
+        size = 256;
+        if(*endPtr == ':')
+        {
+            // Memory size of the EEPROM in bytes.
+            size = strtoul(endPtr + 1, &endPtr, 0);
+        }
+
+        if((type >= (sizeof(typeNames) / sizeof(typeNames[0]))) || ((*endPtr != ',') && (*endPtr != 0)) || (addr > 0x7F) ||
+            (addSimSlave(simDevice, type, (unsigned char)addr, (unsigned int)size) == EXEC_FAIL))
+        {
+            // Unknown slave type, invalid address / size or the address is already in use.
+            return EXEC_FAIL;
+        }
+
+        separator = endPtr;
+    }
+
+    return EXEC_SUCCESS;
+}
+
+static unsigned char simBusStart(struct SimDevice *simDevice)
+{
+    if(simDevice->activeSlave != NULL)
+    {
+        // Repeated START ends the current transfer of the addressed slave.
+        if(simDevice->activeSlave->ops->stop != NULL)
+        {
+            simDevice->activeSlave->ops->stop(simDevice->activeSlave);
+        }
+
+        simDevice->activeSlave = NULL;
+    }
+
+    simDevice->busStatus = (simDevice->busStatus == TWI_STATUS_NO_INFO) ? TWI_STATUS_START : TWI_STATUS_REP_START;
+    simDevice->busCycles++;
+    return simDevice->busStatus;
+}
+
+static void simBusStop(struct SimDevice *simDevice)
+{
+    if((simDevice->activeSlave != NULL) && (simDevice->activeSlave->ops->stop != NULL))
+    {
+        simDevice->activeSlave->ops->stop(simDevice->activeSlave);
+    }
+
+    simDevice->activeSlave = NULL;
+    simDevice->busStatus = TWI_STATUS_NO_INFO;
+    simDevice->busCycles++;
+}
+
+static unsigned char simBusWrite(struct SimDevice *simDevice, unsigned char data)
+{
+    struct SimSlave *slave;
+    unsigned char ack;
+
+    switch(simDevice->busStatus)
+    {
+    case TWI_STATUS_START:
+    case TWI_STATUS_REP_START:
+        // Slave address with read/write flag.
+        slave = findSimSlave(simDevice, data >> 1);
+        ack = (slave != NULL) && slave->ops->address(slave, data >> 1, data & 0x01);
+        simDevice->activeSlave = ack ? slave : NULL;
+
+        if(data & 0x01)
+        {
+            simDevice->busStatus = ack ? TWI_STATUS_MR_SLA_ACK : TWI_STATUS_MR_SLA_NACK;
+        }
+        else
+        {
+            simDevice->busStatus = ack ? TWI_STATUS_MT_SLA_ACK : TWI_STATUS_MT_SLA_NACK;
+        }
+        break;
+    case TWI_STATUS_MT_SLA_ACK:
+    case TWI_STATUS_MT_DATA_ACK:
+        // Data byte to the addressed slave.
+        ack = simDevice->activeSlave->ops->write(simDevice->activeSlave, data);
+        simDevice->busStatus = ack ? TWI_STATUS_MT_DATA_ACK : TWI_STATUS_MT_DATA_NACK;
+        break;
+    default:
+        // TWI does not complete the operation in this bus state, firmware reports the stretch timeout.
+        return RET_TIMEOUT_FAIL;
+    }
+
+    // 8 data bits and the acknowledge bit.
+    simDevice->busCycles += 9;
+    return simDevice->busStatus;
+}
+
+static unsigned char simBusRead(struct SimDevice *simDevice, unsigned char ack, unsigned char *data)
+{
+    if((simDevice->busStatus != TWI_STATUS_MR_SLA_ACK) && (simDevice->busStatus != TWI_STATUS_MR_DATA_ACK))
+    {
+        // Slave is not addressed for reading, firmware reports the stretch timeout.
+        *data = 0;
+        return RET_TIMEOUT_FAIL;
+    }
+
+    *data = simDevice->activeSlave->ops->read(simDevice->activeSlave);
+    simDevice->busStatus = ack ? TWI_STATUS_MR_DATA_ACK : TWI_STATUS_MR_DATA_NACK;
+    simDevice->busCycles += 9;
+    return simDevice->busStatus;
+}
+
+static unsigned char simBusTransfer(struct SimDevice *simDevice, struct SimMessage *messages, unsigned char count)
+{
+    unsigned char msgPos, status;
+    struct SimMessage *msg;
+
+    for(msgPos = 0; msgPos < count; msgPos++)
+    {
+        messages[msgPos].done = 0;
+    }
+
+    status = simDevice->busStatus;
+    if(messages[0].flags & SIM_MSG_NO_START)
+    {
+        // Continue the transaction addressed by the previous commands, bus must be in the same direction.
+        if(!((messages[0].addr & 0x01) ? ((status == TWI_STATUS_MR_SLA_ACK) || (status == TWI_STATUS_MR_DATA_ACK)) : 
+            ((status == TWI_STATUS_MT_SLA_ACK) || (status == TWI_STATUS_MT_DATA_ACK))))
+        {
+            return RET_UNKNOWN;
+        }
+    }
+
+    for(msgPos = 0; msgPos < count; msgPos++)
+    {
+        msg = &messages[msgPos];
+        if(!(msg->flags & SIM_MSG_NO_START))
+        {
+            // (Repeated) START and slave address of the message.
+            simBusStart(simDevice);
+            status = simBusWrite(simDevice, msg->addr);
+            if((status != TWI_STATUS_MT_SLA_ACK) && (status != TWI_STATUS_MR_SLA_ACK))
+            {
+                simBusStop(simDevice);
+                return status;
+            }
+        }
+
+        while(msg->done < msg->length)
+        {
+            if(msg->addr & 0x01)
+            {
+                // Send ACK for all the bytes except the last one (unless requested).
+                status = simBusRead(simDevice, ((msg->done < (msg->length - 1)) || (msg->flags & SIM_MSG_LAST_ACK)), &msg->data[msg->done]);
+                msg->done++;
+                continue;
+            }
+
+            status = simBusWrite(simDevice, msg->data[msg->done]);
+            if(status != TWI_STATUS_MT_DATA_ACK)
+            {
+                if(!(messages[count - 1].flags & SIM_MSG_NO_STOP))
+                {
+                    // Data byte is rejected, release the bus and abort the transaction.
+                    simBusStop(simDevice);
+                }
+
+                return status;
+            }
+
+            msg->done++;
+        }
+    }
+
+    if(!(messages[count - 1].flags & SIM_MSG_NO_STOP))
+    {
+        // All the messages are transferred, release the bus.
+        simBusStop(simDevice);
+    }
+
+    return status;
+}
+
+static uint64_t getSimClock()
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000ULL) + (now.tv_nsec / 1000000);
+}
+
+static void simSampleRun(struct SimDevice *simDevice)
+{
+    unsigned char entryPos, status;
+    unsigned char *frame;
+    struct SimMessage regMessages[2];
+
+    simDevice->sampleDue = 0;
+    if(simDevice->sampleFrames >= simDevice->sampleSlotCount)
+    {
+        // Ring is full, host is not draining the frames fast enough.
+        simDevice->sampleMissed = (simDevice->sampleMissed < 0xFF) ? (simDevice->sampleMissed + 1) : 0xFF;
+        return;
+    }
+
+    // Frame format: SEQUENCE | STATUS | DATA OF EACH ENTRY
+    frame = &simDevice->sampleRing[simDevice->sampleHead * simDevice->sampleFrameSize];
+    frame[0] = simDevice->sampleSequence++;
+    frame[1] = RET_SUCCESS;
+
+    regMessages[0].flags = 0;
+    regMessages[0].length = 1;
+    regMessages[1].flags = 0;
+    regMessages[1].data = &frame[SAMPLE_FRAME_HEADER];
+
+    for(entryPos = 0; entryPos < simDevice->sampleEntryCount; entryPos++)
+    {
+        // Register read: START | SLA+W | REGISTER | REPEATED START | SLA+R | DATA... | STOP
+        regMessages[0].addr = (simDevice->sampleEntries[entryPos].addr << 1);
+        regMessages[0].data = &simDevice->sampleEntries[entryPos].reg;
+        regMessages[1].addr = ((simDevice->sampleEntries[entryPos].addr << 1) | 0x01);
+        regMessages[1].length = simDevice->sampleEntries[entryPos].length;
+
+        // Transfer returns the TWI status of the last step, a successful read ends with a received data byte.
+        status = simBusTransfer(simDevice, regMessages, 2);
+        if((status != TWI_STATUS_MR_DATA_NACK) && (status != TWI_STATUS_MR_DATA_ACK) && (frame[1] == RET_SUCCESS))
+        {
+            // Keep the status of the first failing read, rest of the entries are still sampled.
+            frame[1] = status;
+        }
+
+        regMessages[1].data += simDevice->sampleEntries[entryPos].length;
+    }
+
+    simDevice->sampleHead = ((simDevice->sampleHead + 1) >= simDevice->sampleSlotCount) ? 0 : (simDevice->sampleHead + 1);
+    simDevice->sampleFrames++;
+}
+
+static void updateSimSampler(struct SimDevice *simDevice)
+{
+    uint64_t now, ticks;
+    unsigned char busIdle = (simDevice->busStatus == TWI_STATUS_NO_INFO);
+
+    if(!simDevice->sampleEnabled)
+    {
+        return;
+    }
+
+    if(busIdle && simDevice->sampleDue)
+    {
+        // Sample is delayed while the host holds the bus, take it after the bus is released.
+        simSampleRun(simDevice);
+    }
+
+    now = getSimClock();
+    if(now < simDevice->sampleNextTime)
+    {
+        // Sampling period is not elapsed yet.
+        return;
+    }
+
+    ticks = ((now - simDevice->sampleNextTime) / simDevice->samplePeriod) + 1;
+    simDevice->sampleNextTime += ticks * simDevice->samplePeriod;
+
+    if(busIdle)
+    {
+        // Bus is idle since the last request, firmware takes a sample in each period until the ring is full.
+        while((ticks > 0) && (simDevice->sampleFrames < simDevice->sampleSlotCount))
+        {
+            simSampleRun(simDevice);
+            ticks--;
+        }
+    }
+    else
+    {
+        // Host holds the bus, only the last period is served after the bus is released.
+        ticks = simDevice->sampleDue ? ticks : (ticks - 1);
+        simDevice->sampleDue = 1;
+    }
+
+    // Periods which are not served are reported as missed (or dropped due to the full ring).
+    simDevice->sampleMissed = ((simDevice->sampleMissed + ticks) > 0xFF) ? 0xFF : (simDevice->sampleMissed + ticks);
+}
+
+static unsigned char simSampleControl(struct SimDevice *simDevice, unsigned char enable)
+{
+    // Stop the sampling and reset the state of the ring.
+    simDevice->sampleEnabled = 0;
+    simDevice->sampleHead = 0;
+    simDevice->sampleTail = 0;
+    simDevice->sampleFrames = 0;
+    simDevice->sampleSequence = 0;
+    simDevice->sampleMissed = 0;
+    simDevice->sampleDue = 0;
+
+    if(!enable)
+    {
+        return RET_SUCCESS;
+    }
+
+    if(simDevice->sampleEntryCount == 0)
+    {
+        // Sampling list is not configured.
+        return RET_UNKNOWN;
+    }
+
+    simDevice->sampleNextTime = getSimClock() + simDevice->samplePeriod;
+    simDevice->sampleEnabled = 1;
+    return RET_SUCCESS;
+}
+
+static unsigned char simSampleConfigure(struct SimDevice *simDevice, unsigned char count, const unsigned char *config)
+{
+    unsigned char entryPos, frameSize;
+    unsigned short period;
+
+    // Reconfiguration stops the sampling and drops the buffered frames.
+    simSampleControl(simDevice, 0);
+    simDevice->sampleEntryCount = 0;
+    simDevice->sampleSlotCount = 0;
+
+    period = config[0] | (config[1] << 8);
+    if((count == 0) || (count > SAMPLE_MAX_ENTRIES) || (period == 0) || (period > SAMPLE_MAX_PERIOD_MS))
+    {
+        return RET_UNKNOWN;
+    }
+
+    config += SAMPLE_CONFIG_HEADER;
+    frameSize = SAMPLE_FRAME_HEADER;
+
+    for(entryPos = 0; entryPos < count; entryPos++, config += SAMPLE_ENTRY_SIZE)
+    {
+        if((config[2] == 0) || ((frameSize + config[2]) > SAMPLE_MAX_FRAME))
+        {
+            return RET_UNKNOWN;
+        }
+
+        simDevice->sampleEntries[entryPos].addr = config[0];
+        simDevice->sampleEntries[entryPos].reg = config[1];
+        simDevice->sampleEntries[entryPos].length = config[2];
+        frameSize += config[2];
+    }
+
+    simDevice->sampleEntryCount = count;
+    simDevice->sampleFrameSize = frameSize;
+    simDevice->sampleSlotCount = SIM_SAMPLE_RING_SIZE / frameSize;
+    simDevice->samplePeriod = period;
+
+    return RET_SUCCESS;
+}
+
+static unsigned char simSampleRead(struct SimDevice *simDevice, unsigned char *data, unsigned char maxLength, unsigned char *frameCount)
+{
+    unsigned char length;
+
+    // Block format: MISSED | FRAME SIZE | FRAMES...
+    data[0] = simDevice->sampleMissed;
+    data[1] = simDevice->sampleFrameSize;
+    simDevice->sampleMissed = 0;
+    length = SAMPLE_BLOCK_HEADER;
+    *frameCount = 0;
+
+    while((simDevice->sampleFrames > 0) && ((length + simDevice->sampleFrameSize) <= maxLength))
+    {
+        memcpy(&data[length], &simDevice->sampleRing[simDevice->sampleTail * simDevice->sampleFrameSize], simDevice->sampleFrameSize);
+        length += simDevice->sampleFrameSize;
+
+        simDevice->sampleTail = ((simDevice->sampleTail + 1) >= simDevice->sampleSlotCount) ? 0 : (simDevice->sampleTail + 1);
+        simDevice->sampleFrames--;
+        (*frameCount)++;
+    }
+
+    return length;
+}
+
+static unsigned char simExecBatch(struct SimDevice *simDevice, unsigned char opCount, const unsigned char *ops, unsigned char *payload, unsigned char *data)
+{
+    unsigned char opPos, opStatus = RET_SUCCESS, opData;
+
+    if(opCount > BATCH_MAX_OPS)
+    {
+        return RET_UNKNOWN;
+    }
+
+    // Operation format: COMMAND | DATA, result format: STATUS | DATA
+    for(opPos = 0; opPos < opCount; opPos++, ops += 2)
+    {
+        opData = 0x00;
+
+        switch(ops[0])
+        {
+        case USB_CMD_I2C_START:
+            opStatus = simBusStart(simDevice);
+            break;
+        case USB_CMD_I2C_STOP:
+            simBusStop(simDevice);
+            opStatus = RET_SUCCESS;
+            break;
+        case USB_CMD_I2C_WRITE_ADDR:
+        case USB_CMD_I2C_WRITE:
+            opStatus = simBusWrite(simDevice, ops[1]);
+            break;
+        case USB_CMD_I2C_READ:
+            opStatus = simBusRead(simDevice, ops[1], &opData);
+            break;
+        default:
+            opStatus = RET_UNKNOWN;
+        }
+
+        payload[opPos * 2] = opStatus;
+        payload[(opPos * 2) + 1] = opData;
+
+        if((opStatus == RET_TIMEOUT_FAIL) || (opStatus == RET_BUS_BUSY_FAIL) || (opStatus == RET_UNKNOWN))
+        {
+            // Abort the batch, rest of the operations depend on this result.
+            opPos++;
+            break;
+        }
+    }
+
+    // DATA0 of the response contains the number of executed operations.
+    *data = opPos;
+    return (opPos == opCount) ? RET_SUCCESS : opStatus;
+}
+
+static unsigned char simExecScan(struct SimDevice *simDevice, unsigned char *payload, unsigned char *data)
+{
+    unsigned char addr, status, scanStatus;
+    struct SimMessage probeMessage;
+
+    // Response payload format: PRESENCE BITMAP | ADDRESS STATUS
+    memset(payload, 0, SCAN_BITMAP_SIZE + SCAN_STATUS_SIZE);
+    *data = 0;
+
+    for(addr = SCAN_FIRST_ADDR; addr <= SCAN_LAST_ADDR; addr++)
+    {
+        // Zero length write message: START | SLA+W | STOP
+        probeMessage.addr = (addr << 1);
+        probeMessage.flags = 0;
+        probeMessage.length = 0;
+        probeMessage.data = NULL;
+
+        status = simBusTransfer(simDevice, &probeMessage, 1);
+        scanStatus = (status == TWI_STATUS_MT_SLA_ACK) ? SCAN_STATUS_ACK : ((status == TWI_STATUS_MT_SLA_NACK) ? SCAN_STATUS_NONE : SCAN_STATUS_ERROR);
+
+        if(scanStatus == SCAN_STATUS_ACK)
+        {
+            payload[addr >> 3] |= (1 << (addr & 0x07));
+            (*data)++;
+        }
+
+        payload[SCAN_BITMAP_SIZE + (addr >> 2)] |= (scanStatus << ((addr & 0x03) * 2));
+    }
+
+    return RET_SUCCESS;
+}
+
+EXEC_STATUS sendSimRequest(struct SimDevice *simDevice, const unsigned char *request, unsigned char *response, unsigned int *pollCount)
+{
+    const unsigned char *args = &request[USB_REQ_HEADER_SIZE];
+    unsigned char *payload = &response[1 + USB_RESP_HEADER_SIZE];
+    struct SimMessage messages[2];
+    unsigned char status = RET_SUCCESS, data = 0x00;
+    unsigned short timeout;
+    unsigned int slavePos;
+
+    if(pollCount != NULL)
+    {
+        // Response is available on the first poll.
+        *pollCount = 1;
+    }
+
+    if((request[0] != SYS_SIGNATURE) || (request[3] != SYS_END_SIGNATURE) || (request[1] == USB_CMD_NONE))
+    {
+        // Firmware drops the malformed requests, host never receives a response.
+        return EXEC_FAIL;
+    }
+
+    // Sampling engine runs between the commands.
+    updateSimSampler(simDevice);
+    memset(response, 0, USB_GET_DATA_BUFFER_SIZE);
+
+    // Every command is picked up by one pass of the firmware service loop.
+    simDevice->stats.usbPolls++;
+    if(request[1] <= STATS_OPCODE_COUNT)
+    {
+        simDevice->stats.commands[request[1] - 1]++;
+    }
+
+    switch(request[1])
+    {
+    case USB_CMD_I2C_INIT:
+        simDevice->comSpeed = (request[2] > TWI_COM_SPEED_400) ? TWI_COM_SPEED_100 : request[2];
+        break;
+    case USB_CMD_I2C_START:
+        status = simBusStart(simDevice);
+        break;
+    case USB_CMD_I2C_STOP:
+        simBusStop(simDevice);
+        break;
+    case USB_CMD_I2C_WRITE_ADDR:
+    case USB_CMD_I2C_WRITE:
+        // Address and data bytes are same on the wire, bus state selects the phase.
+        status = simBusWrite(simDevice, request[2]);
+        break;
+    case USB_CMD_I2C_READ:
+        status = simBusRead(simDevice, request[2], &data);
+        break;
+    case USB_CMD_SET_VOLTAGE:
+        if((request[2] == I2C_OUTPUT_3V3) || (request[2] == I2C_OUTPUT_5V))
+        {
+            simDevice->outputVoltage = request[2];
+        }
+        else
+        {
+            status = RET_UNKNOWN;
+        }
+        break;
+    case USB_CMD_GET_VOLTAGE:
+        data = simDevice->outputVoltage;
+        break;
+    case USB_CMD_RESET:
+        // Stop sampling, release the bus and power cycle the slaves.
+        simSampleControl(simDevice, 0);
+        simBusStop(simDevice);
+        for(slavePos = 0; slavePos < simDevice->slaveCount; slavePos++)
+        {
+            if(simDevice->slaves[slavePos].ops->reset != NULL)
+            {
+                simDevice->slaves[slavePos].ops->reset(&simDevice->slaves[slavePos]);
+            }
+        }
+        break;
+    case USB_CMD_BATCH:
+        status = simExecBatch(simDevice, request[2], args, payload, &data);
+        break;
+    case USB_CMD_I2C_READ_REG:
+        if((args[1] == 0) || (args[1] > REG_MAX_READ_COUNT))
+        {
+            status = RET_UNKNOWN;
+            break;
+        }
+
+        // Select the register, then read with repeated START.
+        messages[0].addr = (request[2] << 1);
+        messages[0].flags = 0;
+        messages[0].length = 1;
+        messages[0].data = (unsigned char *)&args[0];
+        messages[1].addr = ((request[2] << 1) | 0x01);
+        messages[1].flags = 0;
+        messages[1].length = args[1];
+        messages[1].data = payload;
+
+        status = simBusTransfer(simDevice, messages, 2);
+        data = messages[1].done;
+        break;
+    case USB_CMD_I2C_WRITE_REG:
+        if(args[1] > REG_MAX_WRITE_COUNT)
+        {
+            status = RET_UNKNOWN;
+            break;
+        }
+
+        // Select the register and write the data without repeated START.
+        messages[0].addr = (request[2] << 1);
+        messages[0].flags = 0;
+        messages[0].length = 1;
+        messages[0].data = (unsigned char *)&args[0];
+        messages[1].addr = (request[2] << 1);
+        messages[1].flags = SIM_MSG_NO_START;
+        messages[1].length = args[1];
+        messages[1].data = (unsigned char *)&args[2];
+
+        status = simBusTransfer(simDevice, messages, 2);
+        data = messages[1].done;
+        break;
+    case USB_CMD_SET_TIMEOUT:
+        // Bus timing is not simulated, only the arguments are validated.
+        timeout = args[0] | (args[1] << 8);
+        status = ((request[2] > I2C_TIMEOUT_BATCH) || (timeout == 0) || (timeout > I2C_TIMEOUT_MAX_MS)) ? RET_UNKNOWN : RET_SUCCESS;
+        break;
+    case USB_CMD_I2C_SCAN:
+        status = simExecScan(simDevice, payload, &data);
+        break;
+    case USB_CMD_I2C_READ_BULK:
+        if((request[2] == 0) || (request[2] > BULK_MAX_READ_COUNT))
+        {
+            status = RET_UNKNOWN;
+            break;
+        }
+
+        // Continue the read transaction started with START and SLA+R.
+        messages[0].addr = 0x01;
+        messages[0].flags = SIM_MSG_NO_START | SIM_MSG_NO_STOP | (args[0] ? SIM_MSG_LAST_ACK : 0);
+        messages[0].length = request[2];
+        messages[0].data = payload;
+
+        status = simBusTransfer(simDevice, messages, 1);
+        data = messages[0].done;
+        break;
+    case USB_CMD_I2C_WRITE_BULK:
+        if((request[2] == 0) || (request[2] > BULK_MAX_WRITE_COUNT))
+        {
+            status = RET_UNKNOWN;
+            break;
+        }
+
+        // Continue the write transaction started with START and SLA+W.
+        messages[0].addr = 0x00;
+        messages[0].flags = SIM_MSG_NO_START | SIM_MSG_NO_STOP;
+        messages[0].length = request[2];
+        messages[0].data = (unsigned char *)args;
+
+        status = simBusTransfer(simDevice, messages, 1);
+        data = messages[0].done;
+        break;
+    case USB_CMD_SAMPLE_CONFIG:
+        status = simSampleConfigure(simDevice, request[2], args);
+        break;
+    case USB_CMD_SAMPLE_CONTROL:
+        status = simSampleControl(simDevice, request[2]);
+        break;
+    case USB_CMD_SAMPLE_READ:
+        simSampleRead(simDevice, payload, (USB_REPORT_SIZE - USB_RESP_HEADER_SIZE), &data);
+        break;
+    case USB_CMD_GET_STATS:
+        // Bus timing is not simulated, wait iterations and poll gap stay at zero.
+        setDevStatistics(payload, &simDevice->stats);
+        if(request[2])
+        {
+            memset(&simDevice->stats, 0, sizeof(struct DevStatistics));
+        }
+        data = STATS_OPCODE_COUNT;
+        break;
+    default:
+        // Unknown command ID.
+        status = RET_UNKNOWN;
+    }
+
+    if(status == RET_TIMEOUT_FAIL)
+    {
+        simDevice->stats.timeouts++;
+    }
+    else if(status == RET_BUS_BUSY_FAIL)
+    {
+        simDevice->stats.busBusy++;
+    }
+
+    // Response header: SIGNATURE | COMMAND | STATUS | DATA0 | TAG (after the report number).
+    response[1] = SYS_SIGNATURE;
+    response[2] = request[1];
+    response[3] = status;
+    response[4] = data;
+    response[5] = request[4];
+
+    return EXEC_SUCCESS;
+}
+
+static EXEC_STATUS simOpen(struct Transport *transport, const char *target)
+{
+    struct SimDevice *simDevice = createSimDevice();
+
+    // Target of the simulator is the list of the virtual slaves.
+    if((simDevice == NULL) || (addSimSlaves(simDevice, ((target != NULL) ? target : SIM_DEFAULT_SLAVES)) == EXEC_FAIL))
+    {
+        releaseSimDevice(simDevice);
+        return EXEC_FAIL;
+    }
+
+    transport->context = simDevice;
+    return EXEC_SUCCESS;
+}
+
+static struct SimResponse *findSimResponse(struct SimDevice *simDevice, const unsigned char *request)
+{
+    unsigned int slotPos;
+
+    for(slotPos = 0; slotPos < DEV_QUEUE_SIZE; slotPos++)
+    {
+        if(simDevice->responses[slotPos].request == request)
+        {
+            return &simDevice->responses[slotPos];
+        }
+    }
+
+    return NULL;
+}
+
+static EXEC_STATUS simSubmit(struct Transport *transport, const unsigned char *request)
+{
+    struct SimDevice *simDevice = (struct SimDevice *)transport->context;
+    struct SimResponse *slot = findSimResponse(simDevice, NULL);
+
+    if(slot == NULL)
+    {
+        // All the slots are in flight.
+        return EXEC_FAIL;
+    }
+
+    // Request is executed immediately, response is kept in the slot until the wait.
+    slot->status = sendSimRequest(simDevice, request, slot->response, &slot->pollCount);
+    if(slot->status == EXEC_FAIL)
+    {
+        return EXEC_FAIL;
+    }
+
+    slot->request = request;
+    transport->transferCount++;
+    return EXEC_SUCCESS;
+}
+
+static EXEC_STATUS simWait(struct Transport *transport, const unsigned char *request, unsigned char *response, unsigned int *pollCount)
+{
+    struct SimDevice *simDevice = (struct SimDevice *)transport->context;
+    struct SimResponse *slot = (request != NULL) ? findSimResponse(simDevice, request) : NULL;
+
+    if(slot == NULL)
+    {
+        // Request is not submitted to the simulator.
+        return EXEC_FAIL;
+    }
+
+    // Simulated response is taken as same as the feature report polls of a device.
+    memcpy(response, slot->response, USB_GET_DATA_BUFFER_SIZE);
+    transport->transferCount += slot->pollCount;
+    if(pollCount != NULL)
+    {
+        *pollCount = slot->pollCount;
+    }
+
+    slot->request = NULL;
+    return slot->status;
+}
+
+static void simClose(struct Transport *transport)
+{
+    releaseSimDevice((struct SimDevice *)transport->context);
+    transport->context = NULL;
+}
+
+// In-process mock backend, requests are executed by the device simulator on the caller thread.
+const struct TransportOps simTransportOps = {TRANSPORT_SIM, TRANSPORT_CAP_QUEUE, simOpen, simSubmit, simWait, simClose};
\ No newline at end of file
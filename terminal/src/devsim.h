@@ -0,0 +1,145 @@
+//----------------------------------------------------------------------------------
+// I2C Test Terminal - In-Process Device Simulator.
+//
+// Copyright (c) 2021 Dilshan R Jayakody [jayakody2000lk@gmail.com].
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//----------------------------------------------------------------------------------
+
+#ifndef I2C_TERMINAL_DEVICE_SIMULATOR
+#define I2C_TERMINAL_DEVICE_SIMULATOR
+
+#include <stdint.h>
+
+#include "common.h"
+#include "transport.h"
+#include "usbproto.h"
+
+// Message flags of a simulated transfer (ref: i2cdrv.h in firmware).
+#define SIM_MSG_NO_START    0x01
+#define SIM_MSG_NO_STOP     0x02
+#define SIM_MSG_LAST_ACK    0x04
+
+// Size of the sample frame ring (ref: sampler.h in firmware).
+#define SIM_SAMPLE_RING_SIZE    96
+
+#define SIM_MAX_SLAVES      8
+
+// Built-in virtual slave types.
+#define SIM_SLAVE_EEPROM    0   // 24Cxx serial EEPROM, 128 bytes to 64KB.
+#define SIM_SLAVE_SENSOR    1   // Register file with auto-increment register pointer.
+#define SIM_SLAVE_NACK      2   // Slave address is never acknowledged.
+#define SIM_SLAVE_NACK_DATA 3   // Slave address is acknowledged, data bytes are never acknowledged.
+
+// Register file sensor: read-only identification register and a counter of the read transactions.
+#define SIM_SENSOR_REGISTERS    256
+#define SIM_SENSOR_COUNT_REG    0x00
+#define SIM_SENSOR_ID_REG       0x0F
+#define SIM_SENSOR_ID           0x5A
+
+// Virtual bus used if the slaves are not specified: TYPE@ADDRESS[:SIZE], ...
+#define SIM_DEFAULT_SLAVES  "eeprom@0x50:256,sensor@0x48,nack-data@0x30"
+
+struct SimSlave;
+
+// Bus events of the addressed slave. Address and write callbacks return 1 to acknowledge.
+struct SimSlaveOps
+{
+    unsigned char (*address)(struct SimSlave *slave, unsigned char addr, unsigned char read);
+    unsigned char (*write)(struct SimSlave *slave, unsigned char data);
+    unsigned char (*read)(struct SimSlave *slave);
+    void (*stop)(struct SimSlave *slave);
+    void (*reset)(struct SimSlave *slave);      // Power cycle of the slave (USB_CMD_RESET).
+};
+
+struct SimSlave
+{
+    unsigned char addr;             // 7-bit base address.
+    unsigned char addrMask;         // Address bits used to select the memory block.
+    const struct SimSlaveOps *ops;
+    void *context;                  // Owned by the caller of addSimCustomSlave.
+    unsigned char *memory;
+    unsigned int memorySize;
+    unsigned int pageSize;
+    unsigned int pointer;           // Memory / register pointer.
+    unsigned int addrLatch;
+    unsigned char addrBytes;        // Number of memory address bytes in a write.
+    unsigned char addrPhase;        // Number of memory address bytes received in the current write.
+    unsigned char block;            // Memory block selected by the slave address.
+};
+
+struct SimSampleEntry
+{
+    unsigned char addr;
+    unsigned char reg;
+    unsigned char length;
+};
+
+// Response of a submitted request, held until the wait (transport backend).
+struct SimResponse
+{
+    const unsigned char *request;   // NULL if the slot is free.
+    unsigned char response[USB_GET_DATA_BUFFER_SIZE];
+    unsigned int pollCount;
+    EXEC_STATUS status;
+};
+
+struct SimDevice
+{
+    struct SimSlave slaves[SIM_MAX_SLAVES];
+    unsigned int slaveCount;
+    struct SimSlave *activeSlave;
+    unsigned char busStatus;        // TWI status of the last bus operation.
+    unsigned char comSpeed;
+    unsigned char outputVoltage;
+    unsigned long busCycles;        // SCL cycles spent on the bus (START, STOP and 9 bits per byte).
+    struct DevStatistics stats;     // Performance counters (ref: USB_CMD_GET_STATS), queue counters are updated by the caller.
+
+    // Register sampling engine (ref: sampler.c in firmware), driven by the host clock.
+    struct SimSampleEntry sampleEntries[SAMPLE_MAX_ENTRIES];
+    unsigned char sampleEntryCount;
+    unsigned char sampleFrameSize;
+    unsigned char sampleSlotCount;
+    unsigned char sampleRing[SIM_SAMPLE_RING_SIZE];
+    unsigned char sampleHead;
+    unsigned char sampleTail;
+    unsigned char sampleFrames;
+    unsigned char sampleSequence;
+    unsigned char sampleMissed;
+    unsigned char sampleDue;
+    unsigned char sampleEnabled;
+    unsigned short samplePeriod;
+    uint64_t sampleNextTime;        // CLOCK_MONOTONIC in milliseconds.
+
+    // Responses of the requests in flight, same number of slots as the device command queue.
+    struct SimResponse responses[DEV_QUEUE_SIZE];
+};
+
+struct SimDevice *createSimDevice();
+void releaseSimDevice(struct SimDevice *simDevice);
+
+EXEC_STATUS addSimSlave(struct SimDevice *simDevice, unsigned char type, unsigned char addr, unsigned int size);
+EXEC_STATUS addSimSlaves(struct SimDevice *simDevice, const char *spec);
+EXEC_STATUS addSimCustomSlave(struct SimDevice *simDevice, unsigned char addr, const struct SimSlaveOps *ops, void *context);
+
+EXEC_STATUS sendSimRequest(struct SimDevice *simDevice, const unsigned char *request, unsigned char *response, unsigned int *pollCount);
+
+extern const struct TransportOps simTransportOps;
+
+#endif /* I2C_TERMINAL_DEVICE_SIMULATOR */
\ No newline at end of file
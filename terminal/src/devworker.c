@@ -0,0 +1,235 @@
+//----------------------------------------------------------------------------------
+// I2C Test Terminal - Device I/O Worker.
+//
+// Copyright (c) 2021 Dilshan R Jayakody [jayakody2000lk@gmail.com].
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//----------------------------------------------------------------------------------
+
+#include "devworker.h"
+#include "caplog.h"
+
+#include <semaphore.h>
+#include <stddef.h>
+
+static void completeDevRequest(struct DevWorker *worker, struct DevRequest *devRequest, uint64_t startTime)
+{
+    struct CmdQueueEntry *result;
+
+    devRequest->latencyUs = (getCaptureClock() - startTime) / 1000;
+
+    if(isCaptureActive())
+    {
+        // Record the exchange before the caller gets the ownership of the buffers.
+        captureTransaction(worker->deviceId, devRequest->request, devRequest->response, devRequest->status, devRequest->pollCount, startTime);
+    }
+
+    if(devRequest->callback != NULL)
+    {
+        // Caller is notified on the worker thread.
+        devRequest->callback(devRequest);
+        return;
+    }
+
+    // Move the completed request into the result queue.
+    while((result = cmdQueueReserve(&worker->results, 1)) == NULL);
+
+    result->devRequest = devRequest;
+    cmdQueuePush(&worker->results);
+}
+
+void *devWorkerProc(void *dataPtr)
+{
+    struct DevWorker *worker = (struct DevWorker *)dataPtr;
+    struct CmdQueueEntry *entry;
+    struct DevRequest *devRequest;
+    struct DevRequest *inFlight[DEV_QUEUE_SIZE];
+    uint64_t startTimes[DEV_QUEUE_SIZE];
+    unsigned int inFlightHead = 0, inFlightCount = 0, slotPos;
+    unsigned int queueDepth = getTransportQueueDepth(worker->transport);
+    unsigned char stopped = 0;
+
+    while((!stopped) || (inFlightCount > 0))
+    {
+        // Submit the next requests while the transport accepts more requests in flight. Worker blocks on the
+        // request queue only if there is nothing to wait for on the device.
+        while((!stopped) && (inFlightCount < queueDepth) && ((entry = cmdQueuePeek(&worker->requests, (inFlightCount == 0))) != NULL))
+        {
+            devRequest = entry->devRequest;
+            cmdQueuePop(&worker->requests);
+
+            if(devRequest == NULL)
+            {
+                // Stop request from the owner of the worker, requests in flight are completed first.
+                stopped = 1;
+                break;
+            }
+
+            devRequest->pollCount = 0;
+            startTimes[(inFlightHead + inFlightCount) % DEV_QUEUE_SIZE] = getCaptureClock();
+
+            if(submitTransportRequest(worker->transport, devRequest->request) == EXEC_FAIL)
+            {
+                devRequest->status = EXEC_FAIL;
+                completeDevRequest(worker, devRequest, startTimes[(inFlightHead + inFlightCount) % DEV_QUEUE_SIZE]);
+                continue;
+            }
+
+            inFlight[(inFlightHead + inFlightCount) % DEV_QUEUE_SIZE] = devRequest;
+            inFlightCount++;
+        }
+
+        if(inFlightCount == 0)
+        {
+            // Wait for the request queue is interrupted by a signal.
+            continue;
+        }
+
+        // Complete the oldest request in flight, response is written directly into the buffer of the caller.
+        slotPos = inFlightHead;
+        inFlightHead = (inFlightHead + 1) % DEV_QUEUE_SIZE;
+        inFlightCount--;
+
+        devRequest = inFlight[slotPos];
+        devRequest->status = waitTransportResponse(worker->transport, devRequest->request, devRequest->response, &devRequest->pollCount);
+        completeDevRequest(worker, devRequest, startTimes[slotPos]);
+    }
+
+    return NULL;
+}
+
+EXEC_STATUS startDevWorker(struct DevWorker *worker, struct Transport *transport, unsigned char deviceId)
+{
+    worker->transport = transport;
+    worker->deviceId = deviceId;
+    worker->pendingCount = 0;
+
+    cmdQueueInit(&worker->requests);
+    cmdQueueInit(&worker->results);
+
+    // Create long-lived thread to handle all the communication of the device.
+    if(pthread_create(&worker->thread, NULL, devWorkerProc, (void*)worker) != 0)
+    {
+        cmdQueueRelease(&worker->requests);
+        cmdQueueRelease(&worker->results);
+        return EXEC_FAIL;
+    }
+
+    return EXEC_SUCCESS;
+}
+
+void stopDevWorker(struct DevWorker *worker)
+{
+    struct CmdQueueEntry *entry;
+
+    // Drop all the results which are not collected by the owner.
+    while(worker->pendingCount > 0)
+    {
+        getDevResult(worker, 1);
+    }
+
+    // Queue empty request to terminate the worker thread.
+    while((entry = cmdQueueReserve(&worker->requests, 1)) == NULL);
+
+    entry->devRequest = NULL;
+    cmdQueuePush(&worker->requests);
+
+    pthread_join(worker->thread, NULL);
+
+    cmdQueueRelease(&worker->requests);
+    cmdQueueRelease(&worker->results);
+}
+
+EXEC_STATUS submitDevRequest(struct DevWorker *worker, struct DevRequest *devRequest, unsigned char wait)
+{
+    struct CmdQueueEntry *entry;
+
+    // Reserve a slot in the request queue (apply back-pressure if the queue is full).
+    entry = cmdQueueReserve(&worker->requests, wait);
+    if(entry == NULL)
+    {
+        return EXEC_FAIL;
+    }
+
+    if(devRequest->callback == NULL)
+    {
+        // Result must be collected with getDevResult.
+        worker->pendingCount++;
+    }
+
+    entry->devRequest = devRequest;
+    cmdQueuePush(&worker->requests);
+
+    return EXEC_SUCCESS;
+}
+
+struct DevRequest *getDevResult(struct DevWorker *worker, unsigned char wait)
+{
+    struct CmdQueueEntry *entry;
+    struct DevRequest *devRequest;
+
+    if(worker->pendingCount == 0)
+    {
+        // No commands are in progress.
+        return NULL;
+    }
+
+    entry = cmdQueuePeek(&worker->results, wait);
+    if(entry == NULL)
+    {
+        // Result is not available yet.
+        return NULL;
+    }
+
+    devRequest = entry->devRequest;
+    cmdQueuePop(&worker->results);
+    worker->pendingCount--;
+
+    return devRequest;
+}
+
+static void execDevRequestDone(struct DevRequest *devRequest)
+{
+    sem_post((sem_t *)devRequest->context);
+}
+
+EXEC_STATUS execDevRequest(struct DevWorker *worker, const unsigned char *request, unsigned char *response)
+{
+    struct DevRequest devRequest;
+    sem_t requestDone;
+
+    // Blocking execution of a single request, other requests in progress are not affected.
+    sem_init(&requestDone, 0, 0);
+
+    devRequest.request = request;
+    devRequest.response = response;
+    devRequest.callback = execDevRequestDone;
+    devRequest.context = &requestDone;
+
+    if(submitDevRequest(worker, &devRequest, 1) == EXEC_FAIL)
+    {
+        sem_destroy(&requestDone);
+        return EXEC_FAIL;
+    }
+
+    while(sem_wait(&requestDone) != 0);
+    
+    sem_destroy(&requestDone);
+    return devRequest.status;
+}
\ No newline at end of file
@@ -0,0 +1,69 @@
+//----------------------------------------------------------------------------------
+// I2C Test Terminal - Device I/O Worker.
+//
+// Copyright (c) 2021 Dilshan R Jayakody [jayakody2000lk@gmail.com].
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//----------------------------------------------------------------------------------
+
+#ifndef I2C_TERMINAL_DEVICE_WORKER
+#define I2C_TERMINAL_DEVICE_WORKER
+
+#include <pthread.h>
+#include <stdint.h>
+
+#include "common.h"
+#include "cmdqueue.h"
+#include "transport.h"
+
+struct DevRequest;
+typedef void (*DevRequestCallback)(struct DevRequest *devRequest);
+
+// Request and response buffers are owned by the caller and must be valid until the request is completed.
+// Completion is signaled through the callback (called on the worker thread) if available, 
+// otherwise the request is returned by getDevResult in the submission order.
+struct DevRequest
+{
+    const unsigned char *request;   // USB_SET_COMMAND_BUFFER_SIZE bytes.
+    unsigned char *response;        // USB_GET_DATA_BUFFER_SIZE bytes.
+    EXEC_STATUS status;
+    unsigned int pollCount;         // Feature reports / completion records used to get the response.
+    uint64_t latencyUs;             // Time spent on the device link to complete the request.
+    DevRequestCallback callback;
+    void *context;
+};
+
+struct DevWorker
+{
+    struct Transport *transport;    // Owned by the caller, must be open until the worker is stopped.
+    unsigned char deviceId;         // Device index of the session, used by the capture log.
+    pthread_t thread;
+    struct CmdQueue requests;
+    struct CmdQueue results;
+    unsigned int pendingCount;
+};
+
+EXEC_STATUS startDevWorker(struct DevWorker *worker, struct Transport *transport, unsigned char deviceId);
+void stopDevWorker(struct DevWorker *worker);
+
+EXEC_STATUS submitDevRequest(struct DevWorker *worker, struct DevRequest *devRequest, unsigned char wait);
+struct DevRequest *getDevResult(struct DevWorker *worker, unsigned char wait);
+EXEC_STATUS execDevRequest(struct DevWorker *worker, const unsigned char *request, unsigned char *response);
+
+#endif /* I2C_TERMINAL_DEVICE_WORKER */
\ No newline at end of file
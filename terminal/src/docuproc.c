@@ -39,8 +39,18 @@ void showGeneralHelp()
     printHelp(HELP_GEN_CMD_WRITE);
     printHelp(HELP_GEN_CMD_WRITE_ADDR);
     printHelp(HELP_GEN_CMD_READ);
+    printHelp(HELP_GEN_CMD_READ_REG);
+    printHelp(HELP_GEN_CMD_WRITE_REG);
+    printHelp(HELP_GEN_CMD_SCAN);
     printHelp(HELP_GEN_CMD_OUT_VOLTAGE);
     printHelp(HELP_GEN_CMD_RESET);
+    printHelp(HELP_GEN_CMD_BATCH_BEGIN);
+    printHelp(HELP_GEN_CMD_BATCH_END);
+    printHelp(HELP_GEN_CMD_POLL_MODE);
+    printHelp(HELP_GEN_CMD_TIMEOUT);
+    printHelp(HELP_GEN_CMD_SAMPLE);
+    printHelp(HELP_GEN_CMD_STATS);
+    printHelp(HELP_GEN_CMD_DEVICE);
     printHelp(HELP_GEN_CMD_EXIT);
 
     printHelp(HELP_USE_HELP1);
@@ -96,6 +106,9 @@ void showHelp(char **topicId)
             printHelp(HELP_WRITE_INTRO1);
             printHelp(HELP_WRITE_INTRO2);
             printHelp(HELP_WRITE_INTRO3);
+
+            printHelp(HELP_WRITE_BULK1);
+            printHelp(HELP_WRITE_BULK2);
         }
         else if(strcmp((*topicId), "write-address") == 0)
         {
@@ -115,6 +128,41 @@ void showHelp(char **topicId)
             printHelp(HELP_READ_INT_VAL1);
             printHelp(HELP_READ_INT_VAL2);
             printHelp(HELP_READ_INT_VAL3);
+
+            printHelp(HELP_READ_BULK1);
+            printHelp(HELP_READ_BULK2);
+            printHelp(HELP_READ_BULK3);
+            printHelp(HELP_READ_BULK4);
+        }
+        else if(strcmp((*topicId), "read-reg") == 0)
+        {
+            printHelpCmdFormat(HELP_READ_REG_FORMAT);
+            printHelp(HELP_READ_REG_INTRO1);
+            printHelp(HELP_READ_REG_INTRO2);
+            printHelp(HELP_READ_REG_INTRO3);
+
+            printHelp(HELP_READ_REG_SEQ1);
+            printHelp(HELP_READ_REG_SEQ2);
+        }
+        else if(strcmp((*topicId), "write-reg") == 0)
+        {
+            printHelpCmdFormat(HELP_WRITE_REG_FORMAT);
+            printHelp(HELP_WRITE_REG_INTRO1);
+            printHelp(HELP_WRITE_REG_INTRO2);
+            printHelp(HELP_WRITE_REG_INTRO3);
+
+            printHelp(HELP_WRITE_REG_SEQ1);
+            printHelp(HELP_WRITE_REG_SEQ2);
+        }
+        else if(strcmp((*topicId), "scan") == 0)
+        {
+            printHelpCmdFormat(HELP_SCAN_FORMAT);
+            printHelp(HELP_SCAN_INTRO1);
+            printHelp(HELP_SCAN_INTRO2);
+            printHelp(HELP_SCAN_INTRO3);
+
+            printHelp(HELP_SCAN_LEGEND1);
+            printHelp(HELP_SCAN_LEGEND2);
         }
         else if(strcmp((*topicId), "output-voltage") == 0)
         {
@@ -136,6 +184,101 @@ void showHelp(char **topicId)
             printHelp(HELP_RESET_POWER1);
             printHelp(HELP_RESET_POWER2);
         }
+        else if(strcmp((*topicId), "batch-begin") == 0)
+        {
+            printHelpCmdFormat(HELP_BATCH_BEGIN_FORMAT);
+            printHelp(HELP_BATCH_BEGIN_INTRO1);
+            printHelp(HELP_BATCH_BEGIN_INTRO2);
+            printHelp(HELP_BATCH_BEGIN_INTRO3);
+
+            printHelp(HELP_BATCH_BEGIN_LIMIT1);
+            printHelp(HELP_BATCH_BEGIN_LIMIT2);
+        }
+        else if(strcmp((*topicId), "batch-end") == 0)
+        {
+            printHelpCmdFormat(HELP_BATCH_END_FORMAT);
+            printHelp(HELP_BATCH_END_INTRO1);
+            printHelp(HELP_BATCH_END_INTRO2);
+            printHelp(HELP_BATCH_END_INTRO3);
+
+            printHelp(HELP_BATCH_END_ABORT1);
+            printHelp(HELP_BATCH_END_ABORT2);
+        }
+        else if(strcmp((*topicId), "poll-mode") == 0)
+        {
+            printHelpCmdFormat(HELP_POLL_MODE_FORMAT);
+            printHelp(HELP_POLL_MODE_INTRO1);
+            printHelp(HELP_POLL_MODE_INTRO2);
+
+            printHelp(HELP_POLL_MODE_IMMEDIATE);
+            printHelp(HELP_POLL_MODE_SPIN);
+            printHelp(HELP_POLL_MODE_SPIN2);
+            printHelp(HELP_POLL_MODE_BACKOFF);
+            printHelp(HELP_POLL_MODE_EVENT);
+            printHelp(HELP_POLL_MODE_EVENT2);
+
+            printHelp(HELP_POLL_MODE_STATS1);
+            printHelp(HELP_POLL_MODE_STATS2);
+        }
+        else if(strcmp((*topicId), "timeout") == 0)
+        {
+            printHelpCmdFormat(HELP_TIMEOUT_FORMAT);
+            printHelp(HELP_TIMEOUT_INTRO1);
+            printHelp(HELP_TIMEOUT_INTRO2);
+            printHelp(HELP_TIMEOUT_INTRO3);
+
+            printHelp(HELP_TIMEOUT_START);
+            printHelp(HELP_TIMEOUT_STRETCH);
+            printHelp(HELP_TIMEOUT_COMMAND);
+            printHelp(HELP_TIMEOUT_BATCH);
+
+            printHelp(HELP_TIMEOUT_NOTE1);
+        }
+        else if(strcmp((*topicId), "sample") == 0)
+        {
+            printHelpCmdFormat(HELP_SAMPLE_FORMAT);
+            printHelp(HELP_SAMPLE_INTRO1);
+            printHelp(HELP_SAMPLE_INTRO2);
+            printHelp(HELP_SAMPLE_INTRO3);
+
+            printHelp(HELP_SAMPLE_CONFIG);
+            printHelp(HELP_SAMPLE_START);
+            printHelp(HELP_SAMPLE_STOP);
+            printHelp(HELP_SAMPLE_READ);
+
+            printHelp(HELP_SAMPLE_NOTE1);
+            printHelp(HELP_SAMPLE_NOTE2);
+        }
+        else if(strcmp((*topicId), "stats") == 0)
+        {
+            printHelpCmdFormat(HELP_STATS_FORMAT);
+            printHelp(HELP_STATS_INTRO1);
+            printHelp(HELP_STATS_INTRO2);
+
+            printHelp(HELP_STATS_SERVICE);
+            printHelp(HELP_STATS_BUS);
+            printHelp(HELP_STATS_ERRORS);
+            printHelp(HELP_STATS_QUEUE);
+            printHelp(HELP_STATS_QUEUE2);
+            printHelp(HELP_STATS_COMMANDS);
+
+            printHelp(HELP_STATS_NOTE1);
+            printHelp(HELP_STATS_NOTE2);
+        }
+        else if(strcmp((*topicId), "device") == 0)
+        {
+            printHelpCmdFormat(HELP_DEVICE_FORMAT);
+            printHelp(HELP_DEVICE_INTRO1);
+            printHelp(HELP_DEVICE_INTRO2);
+            printHelp(HELP_DEVICE_INTRO3);
+
+            printHelp(HELP_DEVICE_PREFIX1);
+            printHelp(HELP_DEVICE_PREFIX2);
+            printHelp(HELP_DEVICE_PREFIX3);
+
+            printHelp(HELP_DEVICE_NOTE1);
+            printHelp(HELP_DEVICE_NOTE2);
+        }
         else if(strcmp((*topicId), "exit") == 0)
         {
             printHelpCmdFormat(HELP_EXIT_FORMAT);
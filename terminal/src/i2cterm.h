@@ -0,0 +1,48 @@
+//----------------------------------------------------------------------------------
+// I2C Test Terminal - Device Access Library (libi2cterm).
+//
+// Copyright (c) 2021 Dilshan R Jayakody [jayakody2000lk@gmail.com].
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//----------------------------------------------------------------------------------
+
+// Library interface to the I2C terminal device:
+// - transport: backend interface used to execute the requests (hidraw, sim or registered backends).
+// - devlink: device discovery and the HIDRAW transport backend.
+// - usbproto: request frames and the expected length of the responses.
+// - devworker: submit/complete interface, requests are executed in order on a worker thread.
+// - pollctl: strategy used to wait for the response of the device.
+// - caplog: binary capture log of the device exchanges (memory-mapped ring file).
+// - replay: re-issue the captured requests and compare the responses with the capture.
+// - devsim: in-process model of the firmware protocol with virtual I2C slaves (sim transport backend).
+
+#ifndef I2C_TERMINAL_LIBRARY
+#define I2C_TERMINAL_LIBRARY
+
+#include "common.h"
+#include "usbproto.h"
+#include "transport.h"
+#include "devlink.h"
+#include "pollctl.h"
+#include "devworker.h"
+#include "caplog.h"
+#include "replay.h"
+#include "devsim.h"
+
+#endif /* I2C_TERMINAL_LIBRARY */
\ No newline at end of file
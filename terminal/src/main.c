@@ -27,16 +27,8 @@
 #include "termutil.h"
 #include "cmdproc.h"
 
-#include <linux/types.h>
-#include <linux/input.h>
-#include <linux/hidraw.h>
-
-#include <sys/ioctl.h>
-#include <sys/types.h>
-#include <sys/stat.h>
-#include <fcntl.h>
 #include <unistd.h>
-#include <pthread.h>
+#include <getopt.h>
 #include <termios.h>
 
 #include <stdlib.h>
@@ -45,79 +37,265 @@
 #include <time.h> 
 #include <ctype.h>
 
-int main()
+static const struct option cmdOptions[] = 
 {
-    struct udev *udev;
-    struct UsbComData comIntf;
-    char *hidDevPath;
+    {"command", required_argument, NULL, 'c'},
+    {"file", required_argument, NULL, 'f'},
+    {"device", required_argument, NULL, 'd'},
+    {"serial", required_argument, NULL, 's'},
+    {"log", required_argument, NULL, 'l'},
+    {"dump-log", required_argument, NULL, 'L'},
+    {"replay", required_argument, NULL, 'r'},
+    {"replay-fast", no_argument, NULL, 'F'},
+    {"simulate", optional_argument, NULL, 'm'},
+    {"help", no_argument, NULL, 'h'},
+    {NULL, 0, NULL, 0}
+};
+
+int main(int argc, char *argv[])
+{
+    struct TermDevice termDevices[MAX_TERM_DEVICES];
+    struct TermDeviceInfo devInfo[MAX_TERM_DEVICES];
+    struct DevRequest *result;
+    const char *deviceNames[MAX_TERM_DEVICES];
+    const char *devicePaths[MAX_TERM_DEVICES];
+    const char *serialNumbers[MAX_TERM_DEVICES];
+    const char *simSlaves[MAX_TERM_DEVICES];
+    unsigned int devicePathCount = 0, serialCount = 0, simCount = 0, deviceCount = 0;
+    unsigned int infoCount, foundCount, devPos, targets;
     unsigned char *cmdData;
-    EXEC_STATUS status;
-    pthread_t devThread;
-    int termHandler;
-    unsigned char currentVoltage, refreshVoltage;
+    int option;
+    unsigned char refreshVoltage;
+    unsigned char failStatus, exitStatus = 0;
+    FILE *scriptFile = NULL;
+    const char *replayPath = NULL;
+    unsigned char replayMode = REPLAY_MODE_TIMED;
+
+    // Commands are taken from the command line, script file or pipe without any prompts.
+    while((option = getopt_long(argc, argv, "c:f:d:s:l:L:r:m::h", cmdOptions, NULL)) != -1)
+    {
+        switch(option)
+        {
+        case 'd':
+            // Device path can be specified multiple times to open more than one device.
+            if(devicePathCount < MAX_TERM_DEVICES)
+            {
+                devicePaths[devicePathCount++] = optarg;
+            }
+            else
+            {
+                printWarningMsg(DEV_TOO_MANY);
+            }
+            break;
+        case 's':
+            // Serial number can be specified multiple times to open more than one device.
+            if(serialCount < MAX_TERM_DEVICES)
+            {
+                serialNumbers[serialCount++] = optarg;
+            }
+            else
+            {
+                printWarningMsg(DEV_TOO_MANY);
+            }
+            break;
+        case 'l':
+            // All the device exchanges of the session are appended to the capture log.
+            if(openCaptureLog(optarg, CAPTURE_DEFAULT_RECORDS) == EXEC_FAIL)
+            {
+                printCommandError(CAPTURE_NOT_OPEN, optarg);
+                return 1;
+            }
+            break;
+        case 'L':
+            // Print the capture log and exit, devices are not required.
+            closeCaptureLog();
+            return dumpCaptureLog(optarg);
+        case 'r':
+            // Captured session is replayed on the devices instead of the commands.
+            replayPath = optarg;
+            break;
+        case 'F':
+            replayMode = REPLAY_MODE_FAST;
+            break;
+        case 'm':
+            // Simulated device with the specified virtual slaves, can be specified multiple times.
+            if(simCount < MAX_TERM_DEVICES)
+            {
+                simSlaves[simCount++] = (optarg != NULL) ? optarg : SIM_DEFAULT_SLAVES;
+            }
+            else
+            {
+                printWarningMsg(DEV_TOO_MANY);
+            }
+            break;
+        case 'c':
+            setCommandScript(optarg);
+            break;
+        case 'f':
+            scriptFile = (strcmp(optarg, "-") == 0) ? stdin : fopen(optarg, "r");
+            if(scriptFile == NULL)
+            {
+                printCommandError(SCRIPT_NOT_OPEN, optarg);
+                closeCaptureLog();
+                return 1;
+            }
+
+            setCommandFile(scriptFile);
+            break;
+        default:
+            printf(MSG_USAGE, argv[0]);
+            closeCaptureLog();
+            return (option == 'h') ? 0 : 1;
+        }
+    }
+
+    if(isInteractive() && !isatty(STDIN_FILENO))
+    {
+        // Standard input is redirected, execute the commands received through the pipe.
+        setCommandFile(stdin);
+    }
         
-    // Try to find the I2C terminal device on udev. If available get the device path.
-    udev = udev_new();
-    status = getTerminalDevicePath(udev, &hidDevPath);
-    udev_unref(udev);
+    if(devicePathCount > 0)
+    {
+        // Device paths are specified by the user, udev lookup is not required.
+        for(devPos = 0; devPos < devicePathCount; devPos++)
+        {
+            if(openTermDevice(&termDevices[deviceCount], devicePaths[devPos], NULL, deviceCount) == EXEC_FAIL)
+            {
+                closeTerminal(termDevices, deviceCount, scriptFile);
+                return 1;
+            }
 
-    if(status == EXEC_FAIL)
+            deviceCount++;
+        }
+    }
+    else if((serialCount > 0) || (simCount == 0))
     {
-        // Unable to find the device or udev error.
-        printErrorMsg(DEV_NOT_AVAILABLE);
-        return 1;
-    }    
+        // Try to find the I2C terminal devices on udev. If available get the device paths.
+        infoCount = 0;
+        if(serialCount > 0)
+        {
+            for(devPos = 0; devPos < serialCount; devPos++)
+            {
+                if(findTerminalDevices(serialNumbers[devPos], &devInfo[infoCount], 1, &foundCount) == EXEC_FAIL)
+                {
+                    // Device with the specified serial number is not available.
+                    printCommandError(DEV_NOT_AVAILABLE, serialNumbers[devPos]);
+                    releaseTerminalDevices(devInfo, infoCount);
+                    closeTerminal(termDevices, deviceCount, scriptFile);
+                    return 1;
+                }
+
+                infoCount += foundCount;
+            }
+        }
+        else if(findTerminalDevices(NULL, devInfo, MAX_TERM_DEVICES, &infoCount) == EXEC_FAIL)
+        {
+            // Unable to find the device or udev error.
+            printErrorMsg(DEV_NOT_AVAILABLE);
+            closeTerminal(termDevices, deviceCount, scriptFile);
+            return 1;
+        }
 
-    // Open USB device for communication.
-    termHandler = open(hidDevPath, (O_RDWR | O_NONBLOCK));
-    if(termHandler < 0)
+        // Open all the devices found on udev.
+        for(devPos = 0; devPos < infoCount; devPos++)
+        {
+            if(openTermDevice(&termDevices[deviceCount], devInfo[devPos].hidRawPath, devInfo[devPos].serialNumber, deviceCount) == EXEC_FAIL)
+            {
+                releaseTerminalDevices(devInfo, infoCount);
+                closeTerminal(termDevices, deviceCount, scriptFile);
+                return 1;
+            }
+
+            deviceCount++;
+        }
+
+        releaseTerminalDevices(devInfo, infoCount);
+    }
+
+    // Simulated devices are opened after the physical devices.
+    for(devPos = 0; devPos < simCount; devPos++)
     {
-        printErrorMsg(DEV_NOT_OPEN);
-        return 1;
+        if(deviceCount >= MAX_TERM_DEVICES)
+        {
+            printWarningMsg(DEV_TOO_MANY);
+            break;
+        }
+
+        if(openSimTermDevice(&termDevices[deviceCount], simSlaves[devPos], deviceCount) == EXEC_FAIL)
+        {
+            closeTerminal(termDevices, deviceCount, scriptFile);
+            return 1;
+        }
+
+        deviceCount++;
     }
 
-    // Display intro message(s).
-    printf(MSG_INTRO_NAME);
-    printf(MSG_INTRO_HELP);
+    // Get current output voltage from each device.
+    for(devPos = 0; devPos < deviceCount; devPos++)
+    {
+        deviceNames[devPos] = termDevices[devPos].name;
+        termDevices[devPos].currentVoltage = 0;
 
-    // Get current output voltage from the device.
-    currentVoltage = 0;
-    refreshVoltage = 0;
-    if(getCurrentOutputVoltage(termHandler, &currentVoltage) == EXEC_SUCCESS)
+        if(getCurrentOutputVoltage(&termDevices[devPos].worker, &termDevices[devPos].currentVoltage) == EXEC_FAIL)
+        {
+            // Output voltage probe request is fail.
+            printErrorMsg(DEV_COM_OUTPUT_VOLTAGE_FAIL);
+            closeTerminal(termDevices, deviceCount, scriptFile);
+            return 1;
+        }
+    }
+
+    setCommandDevices(deviceNames, deviceCount);
+
+    if(replayPath != NULL)
     {
-        // Current output voltage received from the device.
-        printf(MSG_OUTPUT_VOLTAGE, (currentVoltage == I2C_OUTPUT_5V) ? "5.0" : "3.3");
+        // Exit status of the replay is 0 only if the devices respond same as the capture.
+        exitStatus = runReplay(replayPath, termDevices, deviceCount, replayMode);
+        closeTerminal(termDevices, deviceCount, scriptFile);
+        return exitStatus;
     }
-    else
+
+    if(isInteractive())
     {
-        // Output voltage probe request is fail.
-        printErrorMsg(DEV_COM_OUTPUT_VOLTAGE_FAIL);
-        return 1;
+        // Display intro message(s).
+        printf(MSG_INTRO_NAME);
+        printf(MSG_INTRO_HELP);
+
+        if(deviceCount > 1)
+        {
+            // Show the index and name of each device used in the command target.
+            printDeviceList(deviceNames, deviceCount, getCommandTarget());
+        }
+
+        for(devPos = 0; devPos < deviceCount; devPos++)
+        {
+            printOutputVoltage(&termDevices[devPos], (deviceCount > 1));
+        }
     }
     
     // Get commands from the user.
+    refreshVoltage = 0;
     while(getCommand(&cmdData) == CMD_STATUS_OK)
     {
         if(cmdData != NULL)
         {            
+            // Devices addressed by the command (selected group or @TARGET prefix).
+            targets = getCommandTarget();
+
             // Confirmation is required to change the I2C output voltage.
             if(cmdData[1] == USB_CMD_SET_VOLTAGE)
             {                
-                // Check specified voltage is same as the current voltage level.
-                if(cmdData[2] != currentVoltage)
+                // Skip the devices which are already at the specified voltage level.
+                for(devPos = 0; devPos < deviceCount; devPos++)
                 {
-                    // Specified voltage level is different from current voltage level.
-                    if(isContinue(PROMPT_VOLTAGE_CHANGE) == EXEC_FAIL)
+                    if(cmdData[2] == termDevices[devPos].currentVoltage)
                     {
-                        // Voltage change is canceled by the user.
-                        free(cmdData);
-                        cmdData = NULL;
-
-                        // No change required, skip USB data submission.
-                        continue;
+                        targets &= ~(1U << devPos);
                     }
                 }
-                else
+
+                if(targets == 0)
                 {
                     // Specified voltage level is equal to the current voltage level.
                     printWarningMsg(CMD_VOLTAGE_SAME);
@@ -130,17 +308,49 @@ int main()
                     continue;
                 }
 
+                // Specified voltage level is different from current voltage level. Scripts are executed without confirmation.
+                if(isInteractive() && (isContinue(PROMPT_VOLTAGE_CHANGE) == EXEC_FAIL))
+                {
+                    // Voltage change is canceled by the user.
+                    free(cmdData);
+                    cmdData = NULL;
+
+                    // No change required, skip USB data submission.
+                    continue;
+                }
+
                 // After the command execute get the voltage level from the device.
                 refreshVoltage = 1;
             }
 
-            // Execute command available in the data buffer.
-            comIntf.comData = cmdData;
-            comIntf.deviceHandler = termHandler;
-            pthread_create(&devThread, NULL, sendDataToDevice, (void*)&comIntf);
+            // Queue command available in the data buffer to the worker of each device, devices execute it in parallel.
+            for(devPos = 0; devPos < deviceCount; devPos++)
+            {
+                if(targets & (1U << devPos))
+                {
+                    termDevices[devPos].devRequest.request = cmdData;
+                    termDevices[devPos].devRequest.response = termDevices[devPos].response;
+                    termDevices[devPos].devRequest.callback = NULL;
+                    termDevices[devPos].devRequest.context = NULL;
+                    submitDevRequest(&termDevices[devPos].worker, &termDevices[devPos].devRequest, 1);
+                }
+            }
+
+            // Wait to finish the USB command on each device and show the results in the device order.
+            for(devPos = 0; devPos < deviceCount; devPos++)
+            {
+                while((result = getDevResult(&termDevices[devPos].worker, 1)) != NULL)
+                {
+                    if(deviceCount > 1)
+                    {
+                        printf(MSG_DEVICE_RESULT, termDevices[devPos].name);
+                    }
 
-            // Wait to finish the USB command.
-            pthread_join(devThread, NULL);
+                    printDeviceResponse(result);
+                    failStatus = getResultFailure(result);
+                    exitStatus = (failStatus != RET_SUCCESS) ? failStatus : exitStatus;
+                }
+            }
 
             // Release command buffer.
             free(cmdData);
@@ -151,16 +361,25 @@ int main()
                 // Need to refresh the voltage level of the system. (associated with voltage-change and reset commands.)
                 refreshVoltage = 0;
 
-                if(getCurrentOutputVoltage(termHandler, &currentVoltage) == EXEC_SUCCESS)
-                {
-                    // Current output voltage received from the device.
-                    printf(MSG_OUTPUT_VOLTAGE, (currentVoltage == I2C_OUTPUT_5V) ? "5.0" : "3.3");
-                }
-                else
+                for(devPos = 0; devPos < deviceCount; devPos++)
                 {
-                    // Output voltage probe request is fail.
-                    printErrorMsg(DEV_COM_OUTPUT_VOLTAGE_FAIL);
-                    return 1;
+                    if((targets & (1U << devPos)) == 0)
+                    {
+                        continue;
+                    }
+
+                    if(getCurrentOutputVoltage(&termDevices[devPos].worker, &termDevices[devPos].currentVoltage) == EXEC_SUCCESS)
+                    {
+                        // Current output voltage received from the device.
+                        printOutputVoltage(&termDevices[devPos], (deviceCount > 1));
+                    }
+                    else
+                    {
+                        // Output voltage probe request is fail.
+                        printErrorMsg(DEV_COM_OUTPUT_VOLTAGE_FAIL);
+                        closeTerminal(termDevices, deviceCount, scriptFile);
+                        return 1;
+                    }
                 }
             }
         }
@@ -173,9 +392,110 @@ int main()
         cmdData = NULL;
     }
 
-    // Close USB device handler and terminate the application.
-    close(termHandler);
-    return 0;
+    // Close USB device handlers and terminate the application.
+    closeTerminal(termDevices, deviceCount, scriptFile);
+
+    // Exit status is the last failing TWI status code, or 1 if the host side failed to execute a command.
+    return ((exitStatus == RET_SUCCESS) && (getCommandErrorCount() > 0)) ? 1 : exitStatus;
+}
+
+static EXEC_STATUS startTermDevice(struct TermDevice *termDevice, const char *transportName, const char *target, 
+    const char *openError, unsigned char deviceId)
+{
+    // Open the device over the specified transport backend.
+    if(openTransport(&termDevice->transport, transportName, target) == EXEC_FAIL)
+    {
+        printCommandError(openError, target);
+        return EXEC_FAIL;
+    }
+
+    // Start device I/O worker to handle all the requests of the device.
+    if(startDevWorker(&termDevice->worker, &termDevice->transport, deviceId) == EXEC_FAIL)
+    {
+        printErrorMsg(DEV_WORKER_FAIL);
+        closeTransport(&termDevice->transport);
+        return EXEC_FAIL;
+    }
+
+    return EXEC_SUCCESS;
+}
+
+EXEC_STATUS openTermDevice(struct TermDevice *termDevice, const char *hidRawPath, const char *serialNumber, unsigned char deviceId)
+{
+    const char *devName;
+
+    // Device is named by its serial number, otherwise by the name of the HID-RAW node.
+    devName = strrchr(hidRawPath, '/');
+    devName = (serialNumber != NULL) ? serialNumber : ((devName != NULL) ? (devName + 1) : hidRawPath);
+    snprintf(termDevice->name, TERM_DEVICE_NAME_SIZE, "%s", devName);
+
+    return startTermDevice(termDevice, TRANSPORT_HIDRAW, hidRawPath, DEV_NOT_OPEN, deviceId);
+}
+
+EXEC_STATUS openSimTermDevice(struct TermDevice *termDevice, const char *slaves, unsigned char deviceId)
+{
+    // Simulated device with the virtual slaves on its bus.
+    snprintf(termDevice->name, TERM_DEVICE_NAME_SIZE, SIM_DEVICE_NAME, deviceId);
+    return startTermDevice(termDevice, TRANSPORT_SIM, slaves, SIM_SLAVES_INVALID, deviceId);
+}
+
+void closeTermDevices(struct TermDevice *termDevices, unsigned int deviceCount)
+{
+    unsigned int devPos;
+
+    for(devPos = 0; devPos < deviceCount; devPos++)
+    {
+        stopDevWorker(&termDevices[devPos].worker);
+        closeTransport(&termDevices[devPos].transport);
+    }
+}
+
+void closeTerminal(struct TermDevice *termDevices, unsigned int deviceCount, FILE *scriptFile)
+{
+    // Common cleanup of the normal and the failure exits, capture log header is finalized on close.
+    closeTermDevices(termDevices, deviceCount);
+    closeCaptureLog();
+
+    if((scriptFile != NULL) && (scriptFile != stdin))
+    {
+        fclose(scriptFile);
+    }
+}
+
+void printOutputVoltage(struct TermDevice *termDevice, unsigned char showName)
+{
+    if(showName)
+    {
+        printf(MSG_DEVICE_RESULT, termDevice->name);
+    }
+
+    printf(MSG_OUTPUT_VOLTAGE, (termDevice->currentVoltage == I2C_OUTPUT_5V) ? "5.0" : "3.3");
+}
+
+unsigned char getResultFailure(struct DevRequest *result)
+{
+    unsigned char opPos;
+    unsigned char failStatus = RET_SUCCESS;
+
+    if(result->status == EXEC_FAIL)
+    {
+        // Communication failure has occur while exchanging the feature reports.
+        return 1;
+    }
+
+    if(result->response[2] == USB_CMD_BATCH)
+    {
+        // Check the status of each operation executed by the device.
+        for(opPos = 0; (opPos < result->response[4]) && (opPos < result->request[2]); opPos++)
+        {
+            if(isDeviceFailure(result->response[1 + USB_RESP_HEADER_SIZE + (opPos * 2)]))
+            {
+                failStatus = result->response[1 + USB_RESP_HEADER_SIZE + (opPos * 2)];
+            }
+        }
+    }
+
+    return isDeviceFailure(result->response[3]) ? result->response[3] : failStatus;
 }
 
 EXEC_STATUS isContinue(const unsigned char *msg)
@@ -210,179 +530,156 @@ EXEC_STATUS isContinue(const unsigned char *msg)
     return ((getConfirmation == 'y') || (getConfirmation == 'Y')) ? EXEC_SUCCESS : EXEC_FAIL;
 }
 
-EXEC_STATUS getCurrentOutputVoltage(int deviceHandler, unsigned char *voltage)
+EXEC_STATUS getCurrentOutputVoltage(struct DevWorker *worker, unsigned char *voltage)
 {
-    unsigned char *reqData, *respData;
-    struct timespec req, rem;
-    int status;
-    unsigned char result = EXEC_FAIL;
-
-    // Create request buffer and send it to the device.
-    reqData = createUSBBuffer(USB_CMD_GET_VOLTAGE, 0);
-    respData = NULL;
-
-    status = ioctl(deviceHandler, HIDIOCSFEATURE(USB_SET_COMMAND_BUFFER_SIZE), reqData);
-    if(status >= 0)
-    {
-        // IOCTL is successful, creating data buffer to capture the output from the device.
-        respData = (unsigned char*)calloc(USB_GET_DATA_BUFFER_SIZE, 1);
-        while(ioctl(deviceHandler, HIDIOCGFEATURE(USB_GET_DATA_BUFFER_SIZE), respData) >= 0)
-        {
-            if((respData[1] == SYS_SIGNATURE) && (respData[2] == reqData[1]) && (respData[3] != RET_PENDING))
-            {
-                // Device respond with data / status.
-                *voltage = respData[4];
-                result = EXEC_SUCCESS;
-                break;
-            }
-            
-            // Wait thread for 250ms to get the next feature report.
-            req.tv_sec = 0;
-            req.tv_nsec = 250 * 1000000; 
-            nanosleep(&req , &rem);
+    unsigned char reqData[USB_SET_COMMAND_BUFFER_SIZE];
+    unsigned char respData[USB_GET_DATA_BUFFER_SIZE];
 
-            memset(respData, 0, USB_GET_DATA_BUFFER_SIZE);
-        }
-    }
-    
-    // Release all allocated data buffers.
-    free(reqData);
-    reqData = NULL;
-
-    if(respData != NULL)
+    // Send request to the device and wait for the response.
+    setUSBBuffer(reqData, USB_CMD_GET_VOLTAGE, 0);
+    if(execDevRequest(worker, reqData, respData) == EXEC_FAIL)
     {
-        free(respData);
-        respData = NULL;
+        return EXEC_FAIL;
     }
 
-    return result;
+    // Device respond with data / status.
+    *voltage = respData[4];
+    return EXEC_SUCCESS;
 }
 
-void *sendDataToDevice(void *dataPtr)
+void printDeviceResponse(struct DevRequest *result)
 {
-    struct UsbComData *comData = (struct UsbComData *)dataPtr;
-    struct timespec req, rem;
-    int status;
-    unsigned char readBuffer[USB_GET_DATA_BUFFER_SIZE];
-
-    // Send specified USB data buffer to the device.
-    status = ioctl(comData->deviceHandler, HIDIOCSFEATURE(USB_SET_COMMAND_BUFFER_SIZE), comData->comData);
-    if(status < 0)
+    if(result->status == EXEC_FAIL)
     {
-        // Communication failure has occur while setting up the feature report.
+        // Communication failure has occur while exchanging the feature reports.
         printErrorMsg(DEV_COM_FAIL);
     }
     else
     {
-        // IOCTL is successful, waiting for response from the device.
-        memset(readBuffer, 0, USB_GET_DATA_BUFFER_SIZE);
-        while(ioctl(comData->deviceHandler, HIDIOCGFEATURE(USB_GET_DATA_BUFFER_SIZE), readBuffer) >= 0)
-        {            
-            if((readBuffer[1] == SYS_SIGNATURE) && (readBuffer[2] == comData->comData[1]) && (readBuffer[3] != RET_PENDING))
-            {
-                // Device respond with data / status.
-                break;
-            }
-
-            // Wait thread for 250ms to get the next feature report.
-            req.tv_sec = 0;
-            req.tv_nsec = 250 * 1000000; 
-            nanosleep(&req , &rem);
-
-            memset(readBuffer, 0, USB_GET_DATA_BUFFER_SIZE);
+        if(result->response[2] == USB_CMD_BATCH)
+        {
+            // Print status and data of each operation in the batch.
+            printBatchStatusMsg(result->request, &result->response[1]);
         }
-
-        // print received data and status on terminal.
-        printDeviceStatusMsg(readBuffer[3]);
-
-        // On READ command show received data.            
-        if(readBuffer[2] == USB_CMD_I2C_READ)
+        else
         {
-            printData(readBuffer[4]);
+            // print received data and status on terminal.
+            printDeviceStatusMsg(result->response[3]);
+
+            // On READ command show received data.            
+            if(result->response[2] == USB_CMD_I2C_READ)
+            {
+                printData(result->response[4]);
+            }
+            else if((result->response[2] == USB_CMD_I2C_READ_REG) && (result->response[4] > 0))
+            {
+                // DATA0 contains the number of bytes received from the register.
+                printDataBlock(&result->response[1 + USB_RESP_HEADER_SIZE], result->response[4]);
+            }
+            else if((result->response[2] == USB_CMD_I2C_READ_BULK) && (result->response[4] > 0))
+            {
+                // DATA0 contains the number of bytes received from the slave device.
+                printDataBlock(&result->response[1 + USB_RESP_HEADER_SIZE], result->response[4]);
+            }
+            else if((result->response[2] == USB_CMD_I2C_WRITE_BULK) && (result->response[3] == TWI_STATUS_MT_DATA_NACK) && (result->response[4] < result->request[2]))
+            {
+                // Write is aborted by the slave, DATA0 contains the number of acknowledged bytes, which is the index of the rejected byte.
+                printf(ERROR_BULK_WRITE_FORMATTER, (result->response[4] + 1), result->request[2]);
+            }
+            else if(result->response[2] == USB_CMD_I2C_SCAN)
+            {
+                // Show the address map, DATA0 contains the number of slave devices found.
+                printScanResult(&result->response[1]);
+            }
+            else if(result->response[2] == USB_CMD_SAMPLE_READ)
+            {
+                // Show the sample frames drained from the device.
+                printSampleBlock(&result->response[1]);
+            }
+            else if(result->response[2] == USB_CMD_GET_STATS)
+            {
+                // Show the performance counters of the device.
+                printDeviceStatistics(&result->response[1]);
+            }
         }
-    }    
+    }
 }
 
-EXEC_STATUS getTerminalDevicePath(struct udev *udev, char **hidRawPath)
+int dumpCaptureLog(const char *path)
 {
-    EXEC_STATUS returnVal;
-    struct udev_enumerate *devEnum;
-    struct udev_list_entry *devices, *devEntry;
-    struct udev_device *rawDev, *hidDev, *usbDev;
-    const char *sysfsPath, *devPath, *devVID, *devPID;
-    int parseStatus;
-    unsigned short vid, pid;    
-
-    *hidRawPath = NULL;
-    returnVal = EXEC_FAIL;
-
-    // Perform device scan on HID-RAW device class.
-    devEnum = udev_enumerate_new(udev);
-    udev_enumerate_add_match_subsystem(devEnum, "hidraw");
-    udev_enumerate_scan_devices(devEnum);
-
-    // Get the list of HID devices attached to the system.
-    devices = udev_enumerate_get_list_entry(devEnum);
-
-    // Check for the VID and PID to identify the I2C terminal device entry.
-    udev_list_entry_foreach(devEntry, devices)
+    struct CaptureLog captureLog;
+    struct CaptureRecord record;
+    uint64_t recordPos, firstPos, endPos, incomplete = 0;
+
+    if(mapCaptureLog(path, &captureLog) == EXEC_FAIL)
     {
-        devVID = NULL;
-        devPID = NULL;
-        vid = 0;
-        pid = 0;
-        
-        // Get devices HID RAW udev node.
-        sysfsPath = udev_list_entry_get_name(devEntry);
-        rawDev = udev_device_new_from_syspath(udev, sysfsPath);
+        printCommandError(CAPTURE_NOT_OPEN, path);
+        return 1;
+    }
 
-        // Get devices HID udev node.
-        devPath = udev_device_get_devnode(rawDev);
-        hidDev = udev_device_get_parent_with_subsystem_devtype(rawDev, "hid", NULL);
+    // Ring keeps only the latest records, older records are already overwritten.
+    firstPos = getCaptureFirstIndex(&captureLog);
+    endPos = getCaptureEndIndex(&captureLog);
 
-        if(hidDev)
+    for(recordPos = firstPos; recordPos < endPos; recordPos++)
+    {
+        if(getCaptureRecord(&captureLog, recordPos, &record) == EXEC_FAIL)
         {
-            // Get USB device class to extract VID and PID values.
-            usbDev = udev_device_get_parent_with_subsystem_devtype(rawDev, "usb", "usb_device");
-            if(usbDev)
-            {
-                devVID = udev_device_get_sysattr_value(usbDev, "idVendor");
-                devPID = udev_device_get_sysattr_value(usbDev, "idProduct");
+            // Record is not completely written (writer is terminated or still active).
+            incomplete++;
+            continue;
+        }
 
-                // Get vendor ID of the selected device.
-                if((devVID) && (strlen(devVID) > 0))
-                {
-                    vid = strtol(devVID, NULL, 16);
-                }
+        printCaptureRecord(&record);
+    }
 
-                // Get product ID of the selected device.
-                if((devPID) && (strlen(devPID) > 0))
-                {
-                    pid = strtol(devPID, NULL, 16);
-                }
+    printf(MSG_CAPTURE_SUMMARY, (unsigned long long)(endPos - firstPos), (unsigned long long)firstPos, (unsigned long long)incomplete);
+    unmapCaptureLog(&captureLog);
+    return 0;
+}
 
-                // Check for valid VID and PID.
-                if((vid == I2C_TERMINAL_DEV_VID) && (pid == I2C_TERMINAL_DEV_PID))
-                {
-                    // Copy HID-RAW device path into specified variable.
-                    *hidRawPath = (char*) malloc(strlen(devPath) + 1);
-                    strcpy(*hidRawPath, devPath);
+static void replayResultReceived(const struct CaptureRecord *record, const struct ReplayResult *result, void *context)
+{
+    printReplayResult(record, result);
+}
 
-                    returnVal = EXEC_SUCCESS;
-                }
+int runReplay(const char *path, struct TermDevice *termDevices, unsigned int deviceCount, unsigned char mode)
+{
+    struct CaptureLog captureLog;
+    struct ReplayStatistics stats;
+    struct DevWorker *workers[MAX_TERM_DEVICES];
+    char recordName[24];
+    unsigned int devPos;
+    EXEC_STATUS status;
 
-                free((char*) devVID);
-                free((char*) devPID);
+    if(mapCaptureLog(path, &captureLog) == EXEC_FAIL)
+    {
+        printCommandError(CAPTURE_NOT_OPEN, path);
+        return 1;
+    }
 
-                udev_device_unref(usbDev);
-            }
-        }
+    // Records are mapped to the devices by the device index of the capture.
+    for(devPos = 0; devPos < deviceCount; devPos++)
+    {
+        workers[devPos] = &termDevices[devPos].worker;
+    }
 
-        free((char*) devPath);
+    status = replayCaptureLog(&captureLog, workers, deviceCount, mode, replayResultReceived, NULL, &stats);
+    unmapCaptureLog(&captureLog);
+
+    if(status == EXEC_FAIL)
+    {
+        printErrorMsg(REPLAY_FAIL);
+        return 1;
     }
 
-    // Cleanup allocated data structures.
-    udev_enumerate_unref(devEnum);
+    printReplayStatistics(&stats);
+    if(stats.stopped)
+    {
+        snprintf(recordName, sizeof(recordName), REPLAY_RECORD_NAME, (unsigned long long)stats.stopIndex);
+        printCommandError(REPLAY_STOPPED, recordName);
+        return 1;
+    }
 
-    return returnVal;
+    return ((stats.execDiffCount + stats.statusDiffCount + stats.dataDiffCount) > 0) ? 1 : 0;
 }
\ No newline at end of file
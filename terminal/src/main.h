@@ -25,16 +25,35 @@
 #ifndef I2C_TERMINAL_MAIN
 #define I2C_TERMINAL_MAIN
 
-#include <libudev.h>
+#include <stdio.h>
 
-#include "common.h"
+#include "i2cterm.h"
 
-#define I2C_TERMINAL_DEV_VID    0x16C0
-#define I2C_TERMINAL_DEV_PID    0x1231
+#define TERM_DEVICE_NAME_SIZE   32
+#define SIM_DEVICE_NAME         "sim%u"
+#define REPLAY_RECORD_NAME      "#%llu"
 
-void *sendDataToDevice(void *dataPtr);
-EXEC_STATUS getTerminalDevicePath(struct udev *udev, char **hidRawPath);
-EXEC_STATUS getCurrentOutputVoltage(int deviceHandler, unsigned char *voltage);
+// Device opened by the terminal session, each device has an independent I/O worker.
+struct TermDevice
+{
+    char name[TERM_DEVICE_NAME_SIZE];
+    struct Transport transport;
+    struct DevWorker worker;
+    struct DevRequest devRequest;
+    unsigned char response[USB_GET_DATA_BUFFER_SIZE];
+    unsigned char currentVoltage;
+};
+
+EXEC_STATUS openTermDevice(struct TermDevice *termDevice, const char *hidRawPath, const char *serialNumber, unsigned char deviceId);
+EXEC_STATUS openSimTermDevice(struct TermDevice *termDevice, const char *slaves, unsigned char deviceId);
+void closeTermDevices(struct TermDevice *termDevices, unsigned int deviceCount);
+void closeTerminal(struct TermDevice *termDevices, unsigned int deviceCount, FILE *scriptFile);
+void printOutputVoltage(struct TermDevice *termDevice, unsigned char showName);
+void printDeviceResponse(struct DevRequest *result);
+unsigned char getResultFailure(struct DevRequest *result);
+EXEC_STATUS getCurrentOutputVoltage(struct DevWorker *worker, unsigned char *voltage);
 EXEC_STATUS isContinue(const unsigned char *msg);
+int dumpCaptureLog(const char *path);
+int runReplay(const char *path, struct TermDevice *termDevices, unsigned int deviceCount, unsigned char mode);
 
 #endif /* I2C_TERMINAL_MAIN */
\ No newline at end of file
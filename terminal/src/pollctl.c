@@ -0,0 +1,137 @@
+//----------------------------------------------------------------------------------
+// I2C Test Terminal - Device Response Polling Strategies.
+//
+// Copyright (c) 2021 Dilshan R Jayakody [jayakody2000lk@gmail.com].
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//----------------------------------------------------------------------------------
+
+#include "pollctl.h"
+
+#include <time.h>
+#include <poll.h>
+#include <unistd.h>
+#include <pthread.h>
+
+// Polling strategy of the current session.
+static unsigned char pollMode = POLL_MODE_EVENT;
+
+// Poll count statistics of the current session.
+static unsigned int lastPollCount = 0;
+static unsigned int maxPollCount = 0;
+static unsigned long totalPollCount = 0;
+static unsigned long totalCommandCount = 0;
+
+// Statistics are updated by the I/O worker of each device.
+static pthread_mutex_t statsLock = PTHREAD_MUTEX_INITIALIZER;
+
+void setPollMode(unsigned char mode)
+{
+    pollMode = (mode > POLL_MODE_EVENT) ? POLL_MODE_EVENT : mode;
+}
+
+unsigned char isEventPollMode()
+{
+    return (pollMode == POLL_MODE_EVENT);
+}
+
+void pollBegin(struct PollState *state)
+{
+    state->pollCount = 0;
+    state->resendCount = 0;
+    state->delayUs = POLL_BACKOFF_MIN_US;
+}
+
+void pollWait(struct PollState *state)
+{
+    struct timespec req, rem;
+
+    if((pollMode == POLL_MODE_IMMEDIATE) || ((pollMode == POLL_MODE_SPIN) && (state->pollCount <= POLL_SPIN_COUNT)))
+    {
+        // Feature report transfer itself paces the immediate polls.
+        return;
+    }
+
+    // Wait thread for the current backoff delay and double it for the next poll.
+    req.tv_sec = 0;
+    req.tv_nsec = state->delayUs * 1000;
+    nanosleep(&req, &rem);
+
+    state->delayUs = ((state->delayUs * 2) > POLL_BACKOFF_MAX_US) ? POLL_BACKOFF_MAX_US : (state->delayUs * 2);
+}
+
+EXEC_STATUS pollWaitEvent(struct PollState *state, int deviceHandler, unsigned char *record)
+{
+    struct pollfd devPoll;
+
+    devPoll.fd = deviceHandler;
+    devPoll.events = POLLIN;
+    devPoll.revents = 0;
+
+    // Wait until the device submits a completion record over the interrupt-IN endpoint.
+    if((poll(&devPoll, 1, POLL_EVENT_TIMEOUT_MS) > 0) && (devPoll.revents & POLLIN))
+    {
+        if(read(deviceHandler, record, USB_EVENT_RECORD_SIZE) == USB_EVENT_RECORD_SIZE)
+        {
+            state->pollCount++;
+            return EXEC_SUCCESS;
+        }
+    }
+
+    // Completion record is not available within the timeout period.
+    return EXEC_FAIL;
+}
+
+void flushEvents(int deviceHandler)
+{
+    unsigned char record[USB_EVENT_RECORD_SIZE];
+
+    // Discard stale completion records, device handler is in non-blocking mode.
+    while(read(deviceHandler, record, USB_EVENT_RECORD_SIZE) > 0);
+}
+
+void pollEnd(struct PollState *state)
+{
+    pthread_mutex_lock(&statsLock);
+
+    lastPollCount = state->pollCount;
+    maxPollCount = (lastPollCount > maxPollCount) ? lastPollCount : maxPollCount;
+    
+    totalPollCount += lastPollCount;
+    totalCommandCount++;
+
+    pthread_mutex_unlock(&statsLock);
+}
+
+unsigned char getPollMode()
+{
+    return pollMode;
+}
+
+void getPollStatistics(struct PollStatistics *stats)
+{
+    pthread_mutex_lock(&statsLock);
+
+    stats->commandCount = totalCommandCount;
+    stats->lastPollCount = lastPollCount;
+    stats->maxPollCount = maxPollCount;
+    stats->averagePollCount = (totalCommandCount > 0) ? ((double)totalPollCount / totalCommandCount) : 0.0;
+
+    pthread_mutex_unlock(&statsLock);
+}
\ No newline at end of file
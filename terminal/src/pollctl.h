@@ -0,0 +1,72 @@
+//----------------------------------------------------------------------------------
+// I2C Test Terminal - Device Response Polling Strategies.
+//
+// Copyright (c) 2021 Dilshan R Jayakody [jayakody2000lk@gmail.com].
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//----------------------------------------------------------------------------------
+
+#ifndef I2C_TERMINAL_POLL_CONTROL
+#define I2C_TERMINAL_POLL_CONTROL
+
+#include "common.h"
+
+#define POLL_MODE_IMMEDIATE 0   // Re-poll the device without any delay.
+#define POLL_MODE_SPIN      1   // Re-poll without delay for a while, then backoff.
+#define POLL_MODE_BACKOFF   2   // Exponential backoff from the first poll.
+#define POLL_MODE_EVENT     3   // Wait for the completion record on the interrupt-IN endpoint.
+
+// Number of immediate polls before switching to backoff in POLL_MODE_SPIN.
+#define POLL_SPIN_COUNT     8
+
+// Backoff delay limits in microseconds.
+#define POLL_BACKOFF_MIN_US 50
+#define POLL_BACKOFF_MAX_US 10000
+
+// Time to wait for the completion record before falling back to a feature report poll.
+#define POLL_EVENT_TIMEOUT_MS   100
+
+struct PollState
+{
+    unsigned int pollCount;
+    unsigned int resendCount;       // Requests sent again after the queue full rejection.
+    unsigned int delayUs;
+};
+
+struct PollStatistics
+{
+    unsigned long commandCount;
+    unsigned int lastPollCount;
+    unsigned int maxPollCount;
+    double averagePollCount;
+};
+
+void setPollMode(unsigned char mode);
+unsigned char getPollMode();
+unsigned char isEventPollMode();
+
+void pollBegin(struct PollState *state);
+void pollWait(struct PollState *state);
+EXEC_STATUS pollWaitEvent(struct PollState *state, int deviceHandler, unsigned char *record);
+void flushEvents(int deviceHandler);
+void pollEnd(struct PollState *state);
+
+void getPollStatistics(struct PollStatistics *stats);
+
+#endif /* I2C_TERMINAL_POLL_CONTROL */
\ No newline at end of file
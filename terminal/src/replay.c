@@ -0,0 +1,183 @@
+//----------------------------------------------------------------------------------
+// I2C Test Terminal - Capture Log Replay Engine.
+//
+// Copyright (c) 2021 Dilshan R Jayakody [jayakody2000lk@gmail.com].
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//----------------------------------------------------------------------------------
+
+#include "replay.h"
+#include "usbproto.h"
+
+#include <time.h>
+#include <errno.h>
+
+#include <string.h>
+
+static EXEC_STATUS buildReplayRequest(const struct CaptureRecord *record, unsigned char *request)
+{
+    // Request is rebuilt from the captured header and payload with a new tag.
+    setUSBBuffer(request, record->command, record->data);
+
+    if((record->reqLength < USB_REQ_HEADER_SIZE) || ((record->reqLength - USB_REQ_HEADER_SIZE) > CAPTURE_PAYLOAD_SIZE))
+    {
+        // Request length is damaged in the capture log, request can not be replayed.
+        return EXEC_FAIL;
+    }
+
+    memcpy(&request[USB_REQ_HEADER_SIZE], record->reqPayload, record->reqLength - USB_REQ_HEADER_SIZE);
+    return (getUSBBufferLength(request) == record->reqLength) ? EXEC_SUCCESS : EXEC_FAIL;
+}
+
+static unsigned char compareReplayResult(const struct CaptureRecord *record, const struct DevRequest *devRequest)
+{
+    unsigned char diffFlags = 0;
+    unsigned char payloadLength;
+
+    if(devRequest->status != record->execStatus)
+    {
+        // Host side result is different, response is not comparable.
+        return REPLAY_DIFF_EXEC;
+    }
+
+    if(devRequest->response[3] != record->status)
+    {
+        diffFlags |= REPLAY_DIFF_STATUS;
+    }
+
+    // Complete payload of the response is available in the capture log.
+    payloadLength = (record->respLength > USB_RESP_HEADER_SIZE) ? (record->respLength - USB_RESP_HEADER_SIZE) : 0;
+    payloadLength = (payloadLength > CAPTURE_PAYLOAD_SIZE) ? CAPTURE_PAYLOAD_SIZE : payloadLength;
+
+    if((devRequest->response[4] != record->respData) || 
+        (memcmp(&devRequest->response[1 + USB_RESP_HEADER_SIZE], record->respPayload, payloadLength) != 0))
+    {
+        diffFlags |= REPLAY_DIFF_DATA;
+    }
+
+    return diffFlags;
+}
+
+static void waitReplayTime(uint64_t targetTime)
+{
+    struct timespec target;
+
+    target.tv_sec = targetTime / 1000000000ULL;
+    target.tv_nsec = targetTime % 1000000000ULL;
+
+    // Absolute wait on the capture clock (CLOCK_MONOTONIC), restart if interrupted by a signal.
+    while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &target, NULL) == EINTR);
+}
+
+EXEC_STATUS replayCaptureLog(struct CaptureLog *log, struct DevWorker **workers, unsigned int workerCount, unsigned char mode, 
+    ReplayCallback callback, void *context, struct ReplayStatistics *stats)
+{
+    struct CaptureRecord record;
+    struct DevRequest devRequest;
+    struct ReplayResult result;
+    unsigned char request[USB_SET_COMMAND_BUFFER_SIZE];
+    unsigned char response[USB_GET_DATA_BUFFER_SIZE];
+    uint64_t recordPos, endPos, replayStart, firstTimestamp = 0;
+    unsigned char firstRecord = 1;
+    EXEC_STATUS recordStatus;
+
+    memset(stats, 0, sizeof(struct ReplayStatistics));
+    devRequest.request = request;
+    devRequest.response = response;
+    devRequest.callback = NULL;
+    devRequest.context = NULL;
+
+    endPos = getCaptureEndIndex(log);
+    replayStart = getCaptureClock();
+
+    for(recordPos = getCaptureFirstIndex(log); recordPos < endPos; recordPos++)
+    {
+        recordStatus = getCaptureRecord(log, recordPos, &record);
+        if((recordStatus == EXEC_SUCCESS) && (record.deviceId >= workerCount))
+        {
+            // Record is captured on a device which is not available in this session.
+            stats->skipCount++;
+            continue;
+        }
+
+        if((recordStatus == EXEC_FAIL) || (buildReplayRequest(&record, request) == EXEC_FAIL))
+        {
+            // Record is incomplete or damaged. Later requests depend on the state left by this one, so the
+            // results after it are not comparable with the capture.
+            stats->stopped = 1;
+            stats->stopIndex = recordPos;
+            break;
+        }
+
+        if(firstRecord)
+        {
+            // Timeline of the replay starts at the first replayed record.
+            firstTimestamp = record.timestamp;
+            firstRecord = 0;
+        }
+        else if((mode == REPLAY_MODE_TIMED) && (record.timestamp > firstTimestamp))
+        {
+            // Keep the same offset from the first record as the capture.
+            waitReplayTime(replayStart + (record.timestamp - firstTimestamp));
+        }
+
+        // Requests are replayed one by one to keep the latency comparable with the capture.
+        if(submitDevRequest(workers[record.deviceId], &devRequest, 1) == EXEC_FAIL)
+        {
+            return EXEC_FAIL;
+        }
+
+        while(getDevResult(workers[record.deviceId], 1) == NULL);
+
+        result.index = recordPos;
+        result.execStatus = devRequest.status;
+        result.status = response[3];
+        result.respData = response[4];
+        result.pollCount = devRequest.pollCount;
+        result.latencyUs = (devRequest.latencyUs > UINT32_MAX) ? UINT32_MAX : (uint32_t)devRequest.latencyUs;
+        result.latencyDeltaUs = (int64_t)result.latencyUs - (int64_t)record.latencyUs;
+        result.diffFlags = compareReplayResult(&record, &devRequest);
+
+        // Update replay statistics.
+        stats->execDiffCount += (result.diffFlags & REPLAY_DIFF_EXEC) ? 1 : 0;
+        stats->statusDiffCount += (result.diffFlags & REPLAY_DIFF_STATUS) ? 1 : 0;
+        stats->dataDiffCount += (result.diffFlags & REPLAY_DIFF_DATA) ? 1 : 0;
+        stats->totalLatencyDeltaUs += result.latencyDeltaUs;
+
+        if((stats->replayCount == 0) || (result.latencyDeltaUs < stats->minLatencyDeltaUs))
+        {
+            stats->minLatencyDeltaUs = result.latencyDeltaUs;
+        }
+
+        if((stats->replayCount == 0) || (result.latencyDeltaUs > stats->maxLatencyDeltaUs))
+        {
+            stats->maxLatencyDeltaUs = result.latencyDeltaUs;
+        }
+
+        stats->replayCount++;
+
+        if(callback != NULL)
+        {
+            callback(&record, &result, context);
+        }
+    }
+
+    stats->elapsedUs = (getCaptureClock() - replayStart) / 1000;
+    return EXEC_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,75 @@
+//----------------------------------------------------------------------------------
+// I2C Test Terminal - Capture Log Replay Engine.
+//
+// Copyright (c) 2021 Dilshan R Jayakody [jayakody2000lk@gmail.com].
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//----------------------------------------------------------------------------------
+
+#ifndef I2C_TERMINAL_REPLAY
+#define I2C_TERMINAL_REPLAY
+
+#include <stdint.h>
+
+#include "common.h"
+#include "caplog.h"
+#include "devworker.h"
+
+#define REPLAY_MODE_TIMED   0   // Requests are submitted with the same spacing as the capture.
+#define REPLAY_MODE_FAST    1   // Requests are submitted back-to-back.
+
+// Divergence flags of a replayed request.
+#define REPLAY_DIFF_EXEC    0x01    // Host side execution status is different.
+#define REPLAY_DIFF_STATUS  0x02    // STATUS (TWI status / RET_*) of the response is different.
+#define REPLAY_DIFF_DATA    0x04    // DATA0 or the payload is different.
+
+struct ReplayResult
+{
+    uint64_t index;                 // Index of the record in the capture log.
+    EXEC_STATUS execStatus;
+    unsigned char status;
+    unsigned char respData;
+    unsigned char diffFlags;
+    unsigned int pollCount;
+    uint32_t latencyUs;
+    int64_t latencyDeltaUs;         // Replay latency - captured latency.
+};
+
+struct ReplayStatistics
+{
+    unsigned long replayCount;
+    unsigned long skipCount;        // Records of the devices which are not available in this session.
+    unsigned char stopped;          // Replay is stopped at a request which can not be replayed.
+    uint64_t stopIndex;             // Index of that record in the capture log.
+    unsigned long execDiffCount;
+    unsigned long statusDiffCount;
+    unsigned long dataDiffCount;
+    int64_t totalLatencyDeltaUs;
+    int64_t minLatencyDeltaUs;
+    int64_t maxLatencyDeltaUs;
+    uint64_t elapsedUs;
+};
+
+// Called for each replayed request on the thread which runs the replay.
+typedef void (*ReplayCallback)(const struct CaptureRecord *record, const struct ReplayResult *result, void *context);
+
+EXEC_STATUS replayCaptureLog(struct CaptureLog *log, struct DevWorker **workers, unsigned int workerCount, unsigned char mode, 
+    ReplayCallback callback, void *context, struct ReplayStatistics *stats);
+
+#endif /* I2C_TERMINAL_REPLAY */
\ No newline at end of file
@@ -26,27 +26,92 @@
 #define I2C_TERMINAL_STR_DEF
 
 #define DEV_NOT_AVAILABLE   "I2C Terminal device is not connected to the system or not functioning properly."
+#define DEV_TOO_MANY        "Too many I2C Terminal devices are connected, additional devices are ignored."
 #define DEV_NOT_OPEN        "Unable to open the USB device."
+#define DEV_WORKER_FAIL     "Unable to start the device I/O worker."
+#define SCRIPT_NOT_OPEN     "Unable to open the script file."
+#define CAPTURE_NOT_OPEN    "Unable to open the capture log."
+#define EMU_UHID_NOT_OPEN   "Unable to open the uhid device, uhid module is not loaded or permission is denied."
+#define EMU_CREATE_FAIL     "Unable to create the virtual HID device."
+#define EMU_COM_FAIL        "Communication failure has occur while exchanging events with the uhid driver."
+#define EMU_PARAM_INVALID   "Invalid option value."
+#define BENCH_PARAM_INVALID "Invalid option value."
+#define BENCH_CSV_NOT_OPEN  "Unable to create the CSV report."
+#define BENCH_CASE_UNKNOWN  "Unknown benchmark command type."
+#define BENCH_REGION_INVALID    "Benchmark region does not fit into the address space of the slave."
+#define SIM_SLAVES_INVALID  "Invalid simulated slave list, use TYPE@ADDRESS[:SIZE] with eeprom, sensor, nack or nack-data types."
+#define REPLAY_FAIL         "Replay is aborted, unable to submit the request to the device."
+#define REPLAY_STOPPED      "Replay is stopped, request of the record is incomplete in the capture log."
 
 #define MSG_INTRO_NAME      "I2C Terminal - Copyright (c) 2021 Dilshan R Jayakody. (jayakody2000lk@gmail.com)\n"
 #define MSG_INTRO_HELP      "Type \"\033[1m\033[37mhelp\033[0m\" to list down the available commands. Enter \"\033[1m\033[37mhelp [COMMAND]\033[0m\" to get the information about the specific command.\n"
+#define MSG_USAGE           "Usage: %s [-c \"COMMAND; COMMAND...\"] [-f SCRIPT-FILE] [-d /dev/hidrawN]... [-s SERIAL]... [-l LOG-FILE] [--dump-log LOG-FILE] [-r LOG-FILE [--replay-fast]] [-m[SLAVES]]...\n"
+#define EMU_MSG_USAGE       "Usage: %s [-s SERIAL] [-m SLAVES] [-o OVERHEAD-US] [-k BUS-CLOCK-KHZ]\n"
+#define EMU_MSG_CREATED     "Emulated I2C terminal \033[1m\033[37m%s\033[0m is created, slaves: %s\n"
+#define EMU_MSG_SUMMARY     "Commands: %lu, rejected: %lu, malformed: %lu, completion events: %lu\n"
+#define BENCH_MSG_USAGE     "Usage: %s [-d /dev/hidrawN | -s SERIAL | -m[SLAVES]] [-P POLL-MODE] [-n ITERATIONS] [-a ADDRESS] [-b LENGTH] [-k 100|250|400] [-c COMMAND,COMMAND...] [-t SIZE [-O OFFSET] [-p PAGE-SIZE] [-w 1|2] [-R]] [-o CSV-FILE]\n"
+#define BENCH_MSG_TARGET    "Transport: \033[1m\033[37m%s\033[0m (%s), iterations: %u, polling mode: %s\n"
+#define BENCH_MSG_LATENCY_HEADER    "command         iterations errors     min(us)     p50(us)     p99(us)     max(us) avg-polls max-polls\n"
+#define BENCH_MSG_LATENCY_ROW       "%-15s %10u %6u %11.1f %11.1f %11.1f %11.1f %9.2f %9u\n"
+#define BENCH_MSG_LATENCY_FAIL      "%-15s %10u %6u           -           -           -           -         -         -\n"
+#define BENCH_CSV_LATENCY_HEADER    "command,opcode,iterations,errors,min_us,p50_us,p99_us,max_us,avg_polls,max_polls\n"
+#define BENCH_CSV_LATENCY_ROW       "%s,0x%02x,%u,%u,%.1f,%.1f,%.1f,%.1f,%.2f,%u\n"
+#define BENCH_MSG_XFER_REGION       "Region: offset %u, %u byte(s), page size %u, %u address byte(s), bus clock %ukHz\n"
+#define BENCH_MSG_XFER_HEADER       "path       operation  bytes errors elapsed(ms)     bytes/s requests    polls ack-polls transfers/byte bus-util(%%)\n"
+#define BENCH_MSG_XFER_ROW          "%-10s %-9s %6u %6u %11.1f %11.1f %8lu %8lu %9lu %14.2f %11s\n"
+#define BENCH_MSG_XFER_SKIP         "%-10s skipped, register commands support only the 1-byte memory address.\n"
+#define BENCH_CSV_XFER_HEADER       "path,operation,bytes,errors,elapsed_ms,bytes_per_second,requests,polls,ack_polls,transfers_per_byte,bus_utilisation\n"
+#define BENCH_CSV_XFER_ROW          "%s,%s,%u,%u,%.3f,%.1f,%lu,%lu,%lu,%.3f,%s\n"
 #define MSG_OUTPUT_VOLTAGE  "Current I2C output voltage: \033[1m\033[37m%sV\033[0m\n"
+#define MSG_POLL_MODE       "Response polling mode: \033[1m\033[37m%s\033[0m\n"
+#define MSG_DEVICE_ENTRY    "%c %u: %s\n"
+#define MSG_DEVICE_RESULT   "\033[1m\033[37m[%s]\033[0m\n"
+#define MSG_CAPTURE_RECORD  "%llu.%06llu dev %u cmd 0x%02x data 0x%02x tag %3u -> %s status 0x%02x data 0x%02x polls %u latency %uus\n"
+#define MSG_CAPTURE_SUMMARY "Capture log: %llu record(s), %llu overwritten, %llu incomplete.\n"
+#define MSG_REPLAY_DIFF     "#%llu dev %u cmd 0x%02x data 0x%02x: captured %s status 0x%02x data 0x%02x, replayed %s status 0x%02x data 0x%02x%s\n"
+#define MSG_REPLAY_SUMMARY  "Replayed: %lu, skipped: %lu, host failures: %lu, status divergences: %lu, data divergences: %lu\n"
+#define MSG_REPLAY_LATENCY  "Latency delta (replay - capture): average %.1fus, minimum %lldus, maximum %lldus, elapsed %.3fs\n"
+#define MSG_POLL_STATS      "Commands: %lu, polls for last command: %u, maximum polls: %u, average polls: %.2f\n"
+#define MSG_STATS_SERVICE   "USB service calls: %lu, longest gap between the calls: %.3fms\n"
+#define MSG_STATS_BUS       "I2C wait iterations: %lu, timeouts: %u, bus busy: %u, arbitration lost: %u\n"
+#define MSG_STATS_QUEUE     "Queued commands rejected: %u\n"
+#define MSG_STATS_COMMAND   "  %-16s %u\n"
 
 #define CMD_MSG_UNKNOWN             "Unknown command."
 #define CMD_MSG_PARAMETER_MISSING   "Required parameter(s) are missing."
 #define CMD_MSG_OUTOF_RANGE         "Specified parameter is out of range."
+#define CMD_MSG_ADDR_OUTOF_RANGE    "Specified slave address is out of range, only 7-bit addresses are allowed."
 #define CMD_MSG_SPEED_UNSUPPORT     "Unsupported I2C speed, only 100kHz, 250kHz and 400kHz are supported by the device."
 #define CMD_PARAM_IGNORE            "Specified parameters are ignored by the command."
 #define CMD_PARAM_READ_UNSUPPORTED  "Unsupported read flag, only \033[1m\033[37mack\033[0m, \033[1m\033[37mnack\033[0m, \033[1m\033[37m1\033[0m and \033[1m\033[37m0\033[0m are allowd as parameters."
 #define CMD_PARAM_INVALID_VOLTAGE   "Invalid voltage level, only 3.3V or 5V output is available with the device."
+#define CMD_PARAM_INVALID_POLL      "Invalid polling mode, only \033[1m\033[37mimmediate\033[0m, \033[1m\033[37mspin\033[0m, \033[1m\033[37mbackoff\033[0m and \033[1m\033[37mevent\033[0m are supported."
+#define CMD_PARAM_INVALID_TIMEOUT   "Invalid timeout type, only \033[1m\033[37mstart\033[0m, \033[1m\033[37mstretch\033[0m, \033[1m\033[37mcommand\033[0m and \033[1m\033[37mbatch\033[0m are supported."
+#define CMD_MSG_DEVICE_UNKNOWN      "Unknown device, specify the device index, device name or \033[1m\033[37mall\033[0m."
+#define CMD_MSG_SAMPLE_PERIOD       "Specified sampling period is out of range, period must be between 1ms and 60000ms."
+#define CMD_MSG_SAMPLE_FRAME        "Sampling list is too large, up to 8 registers and 30 data bytes are allowed."
+#define CMD_PARAM_INVALID_STATS     "Invalid stats operation, only \033[1m\033[37mreset\033[0m is supported."
+#define CMD_PARAM_INVALID_SAMPLE    "Invalid sample operation, only \033[1m\033[37mconfig\033[0m, \033[1m\033[37mstart\033[0m, \033[1m\033[37mstop\033[0m and \033[1m\033[37mread\033[0m are supported."
+#define CMD_MSG_TIMEOUT_OUTOF_RANGE "Specified timeout is out of range, timeout must be between 1ms and 4000ms."
 #define CMD_VOLTAGE_SAME            "Current output voltage is same as the specified voltage."
+#define CMD_BATCH_ACTIVE            "Batch is already started, operations are appended to the current batch."
+#define CMD_BATCH_NOT_ACTIVE        "Batch is not started, use \033[1m\033[37mbatch-begin\033[0m to start a new batch."
+#define CMD_BATCH_EMPTY             "Batch does not contain any operation, nothing to execute."
+#define CMD_BATCH_FULL              "Batch is full, use \033[1m\033[37mbatch-end\033[0m to execute the recorded operations."
+#define CMD_BATCH_UNSUPPORTED       "Only start, stop, write, write-address and read commands are allowed inside a batch."
 
 #define PROMPT_VOLTAGE_CHANGE       "Selected voltage level is different from the current output voltage, continue the voltage change"
 
 #define DEV_COM_FAIL                "Communication failure has occur while writing data to the device."
 #define DEV_COM_TIMEOUT             "I2C timeout occur, slave device is not responding."
+#define DEV_COM_BUS_BUSY            "I2C bus is busy, unable to transmit the START condition."
 #define DEV_COM_UNKNOWN             "Unknown I2C error."
+#define DEV_COM_QUEUE_FULL          "Command queue of the device is full."
 #define DEV_COM_OUTPUT_VOLTAGE_FAIL "Unable to get I2C output voltage from the device."
+#define DEV_COM_BATCH_ABORTED       "Batch is aborted, %d of %d operation(s) are executed."
+#define DEV_COM_BULK_WRITE_ABORTED  "Write is aborted, byte %d of %d is not acknowledged by the slave device."
+#define DEV_COM_SAMPLE_MISSED       "%d sample(s) are missed or dropped by the device.\n"
+#define DEV_COM_SCAN_FOUND          "%d slave device(s) found on the bus.\n"
 
 #define DEV_COM_START_TX        "A START condition has been transmitted."
 #define DEV_COM_REPEAT_START    "A repeated START condition has been transmitted."
@@ -35,8 +35,18 @@
 #define HELP_GEN_CMD_WRITE          "- write"
 #define HELP_GEN_CMD_WRITE_ADDR     "- write-address"
 #define HELP_GEN_CMD_READ           "- read"
+#define HELP_GEN_CMD_READ_REG       "- read-reg"
+#define HELP_GEN_CMD_WRITE_REG      "- write-reg"
+#define HELP_GEN_CMD_SCAN           "- scan"
 #define HELP_GEN_CMD_OUT_VOLTAGE    "- output-voltage"
 #define HELP_GEN_CMD_RESET          "- reset"
+#define HELP_GEN_CMD_BATCH_BEGIN    "- batch-begin"
+#define HELP_GEN_CMD_BATCH_END      "- batch-end"
+#define HELP_GEN_CMD_POLL_MODE      "- poll-mode"
+#define HELP_GEN_CMD_TIMEOUT        "- timeout"
+#define HELP_GEN_CMD_SAMPLE         "- sample"
+#define HELP_GEN_CMD_STATS          "- stats"
+#define HELP_GEN_CMD_DEVICE         "- device"
 #define HELP_GEN_CMD_EXIT           "- exit"
 
 #define HELP_USE_HELP1  "\nTo get details, enter the help command with one of the above commands."
@@ -77,10 +87,13 @@
 
 // Help for WRITE command.
 
-#define HELP_WRITE_FORMAT   "Format: write [VALUE]"
+#define HELP_WRITE_FORMAT   "Format: write [VALUE...]"
 #define HELP_WRITE_INTRO1   "\nWrite/send specified \033[1m\033[37m[VALUE]\033[0m into the I2C bus. In this command, \033[1m\033[37m[VALUE]\033[0m"
 #define HELP_WRITE_INTRO2   "is an 8-bit (base 10) integer or hexadecimal value. All hexadecimal values"
-#define HELP_WRITE_INTRO3   "must begin with the \"\033[1m\033[37m0x\033[0m\" prefix.\n"
+#define HELP_WRITE_INTRO3   "must begin with the \"\033[1m\033[37m0x\033[0m\" prefix."
+
+#define HELP_WRITE_BULK1    "\nUp to 123 values can be specified in one command. The device writes them"
+#define HELP_WRITE_BULK2    "back-to-back and stops at the first byte which is not acknowledged.\n"
 
 // Help for WRITE-ADDRESS command.
 
@@ -92,14 +105,49 @@
 
 // Help for READ command.
 
-#define HELP_READ_FORMAT    "Format: read {FLAG}"
+#define HELP_READ_FORMAT    "Format: read {FLAG} / read [COUNT] {FLAG}"
 #define HELP_READ_INTRO1    "\nRead data byte available in the I2C bus. In this command, \033[1m\033[37m{FLAG}\033[0m is an"
 #define HELP_READ_INTRO2    "optional value to specify the ACK or NACK condition. If \033[1m\033[37m{FLAG}\033[0m is not"
 #define HELP_READ_INTRO3    "specified, the I2C terminal issue NACK to the I2C slave device."
 
 #define HELP_READ_INT_VAL1  "\nThe \033[1m\033[37m{FLAG}\033[0m parameter also accepts integer values as ACK or NACK. For"
 #define HELP_READ_INT_VAL2  "the ACK, specify 1 for the \033[1m\033[37m{FLAG}\033[0m parameter, and use 0 for the NACK"
-#define HELP_READ_INT_VAL3  "condition.\n"
+#define HELP_READ_INT_VAL3  "condition."
+
+#define HELP_READ_BULK1     "\nTo read more than one byte, specify the number of bytes as \033[1m\033[37m[COUNT]\033[0m. Up to"
+#define HELP_READ_BULK2     "123 bytes are received in one request, ACK is issued for all the bytes except"
+#define HELP_READ_BULK3     "the last one. \033[1m\033[37m{FLAG}\033[0m sets the condition of the last byte (NACK by default),"
+#define HELP_READ_BULK4     "use ack to continue the sequential read with the next read command.\n"
+
+// Help for READ-REG command.
+
+#define HELP_READ_REG_FORMAT    "Format: read-reg [ADDRESS] [REGISTER] {COUNT}"
+#define HELP_READ_REG_INTRO1    "\nRead \033[1m\033[37m{COUNT}\033[0m bytes starting from the \033[1m\033[37m[REGISTER]\033[0m of the slave device. In"
+#define HELP_READ_REG_INTRO2    "this command, \033[1m\033[37m[ADDRESS]\033[0m is the 7-bit slave address without the read/write"
+#define HELP_READ_REG_INTRO3    "flag. If \033[1m\033[37m{COUNT}\033[0m is not specified, a single byte is read from the register."
+
+#define HELP_READ_REG_SEQ1      "\nThe device executes START, SLA+W, REGISTER, repeated START, SLA+R, DATA..."
+#define HELP_READ_REG_SEQ2      "and STOP as one I2C transaction. Up to 123 bytes can be read at once.\n"
+
+// Help for WRITE-REG command.
+
+#define HELP_WRITE_REG_FORMAT   "Format: write-reg [ADDRESS] [REGISTER] [VALUE...]"
+#define HELP_WRITE_REG_INTRO1   "\nWrite one or more \033[1m\033[37m[VALUE]\033[0m bytes starting from the \033[1m\033[37m[REGISTER]\033[0m of the slave"
+#define HELP_WRITE_REG_INTRO2   "device. In this command, \033[1m\033[37m[ADDRESS]\033[0m is the 7-bit slave address without the"
+#define HELP_WRITE_REG_INTRO3   "read/write flag."
+
+#define HELP_WRITE_REG_SEQ1     "\nThe device executes START, SLA+W, REGISTER, DATA... and STOP as one I2C"
+#define HELP_WRITE_REG_SEQ2     "transaction. Up to 121 bytes can be written at once.\n"
+
+// Help for SCAN command.
+
+#define HELP_SCAN_FORMAT    "Format: scan"
+#define HELP_SCAN_INTRO1    "\nProbe all the 7-bit slave addresses from 0x08 to 0x77 and show the address"
+#define HELP_SCAN_INTRO2    "of each slave device which acknowledges. The device sends START, SLA+W and"
+#define HELP_SCAN_INTRO3    "STOP for each address and returns the result of the complete scan at once."
+
+#define HELP_SCAN_LEGEND1   "\nIn the address map, -- is used for the addresses without a slave device, TO"
+#define HELP_SCAN_LEGEND2   "for the timeouts and XX for the bus errors.\n"
 
 // Help for SET-VOLTAGE command.
 
@@ -121,6 +169,101 @@
 #define HELP_RESET_POWER1   "\nDuring the power reset I2C terminal does not reset the voltage level of"
 #define HELP_RESET_POWER2   "the output terminal.\n"
 
+// Help for BATCH-BEGIN command.
+
+#define HELP_BATCH_BEGIN_FORMAT "Format: batch-begin"
+#define HELP_BATCH_BEGIN_INTRO1 "\nStart recording a batch of I2C operations. After this command, \033[1m\033[37mstart\033[0m,"
+#define HELP_BATCH_BEGIN_INTRO2 "\033[1m\033[37mstop\033[0m, \033[1m\033[37mwrite\033[0m, \033[1m\033[37mwrite-address\033[0m and \033[1m\033[37mread\033[0m commands are not sent to the device"
+#define HELP_BATCH_BEGIN_INTRO3 "immediately. Instead, those are queued until the \033[1m\033[37mbatch-end\033[0m command is issued."
+
+#define HELP_BATCH_BEGIN_LIMIT1 "\nA single batch can hold up to 61 operations. A START command issued in the"
+#define HELP_BATCH_BEGIN_LIMIT2 "middle of the batch is transmitted as a repeated START condition.\n"
+
+// Help for BATCH-END command.
+
+#define HELP_BATCH_END_FORMAT   "Format: batch-end"
+#define HELP_BATCH_END_INTRO1   "\nSend all the operations recorded after the \033[1m\033[37mbatch-begin\033[0m command to the"
+#define HELP_BATCH_END_INTRO2   "device as a single request. The device executes the operations back-to-back"
+#define HELP_BATCH_END_INTRO3   "and returns the status (and received data) of each operation at once."
+
+#define HELP_BATCH_END_ABORT1   "\nIf the slave device is not responding, the device stops executing the rest"
+#define HELP_BATCH_END_ABORT2   "of the operations in the batch.\n"
+
+// Help for POLL-MODE command.
+
+#define HELP_POLL_MODE_FORMAT   "Format: poll-mode {MODE}"
+#define HELP_POLL_MODE_INTRO1   "\nSet the strategy used to wait for the response of the device. In this"
+#define HELP_POLL_MODE_INTRO2   "command, \033[1m\033[37m{MODE}\033[0m is an optional value and it can be one of the following:"
+
+#define HELP_POLL_MODE_IMMEDIATE    "\nimmediate: Request the response again without any delay."
+#define HELP_POLL_MODE_SPIN         "spin: Request the response without delay for the first few attempts and"
+#define HELP_POLL_MODE_SPIN2        "      then continue with the exponential backoff."
+#define HELP_POLL_MODE_BACKOFF      "backoff: Double the delay between each attempt up to 10ms."
+#define HELP_POLL_MODE_EVENT        "event: Wait until the device notifies the completion of the command over"
+#define HELP_POLL_MODE_EVENT2       "       the interrupt-IN endpoint. (default)"
+
+#define HELP_POLL_MODE_STATS1   "\nThis command also shows the current mode and the number of polls required"
+#define HELP_POLL_MODE_STATS2   "to get the response from the device.\n"
+
+// Help for TIMEOUT command.
+
+#define HELP_TIMEOUT_FORMAT     "Format: timeout [TYPE] [MILLISECONDS]"
+#define HELP_TIMEOUT_INTRO1     "\nSet the I2C bus timeouts of the device. The device measures the timeouts with"
+#define HELP_TIMEOUT_INTRO2     "a hardware timer and \033[1m\033[37m[MILLISECONDS]\033[0m can be between 1 and 4000. \033[1m\033[37m[TYPE]\033[0m can"
+#define HELP_TIMEOUT_INTRO3     "be one of the following:"
+
+#define HELP_TIMEOUT_START      "\nstart: Wait for the bus to be free to transmit the START condition. (50ms)"
+#define HELP_TIMEOUT_STRETCH    "stretch: Wait for the slave device to release the clock line. (25ms)"
+#define HELP_TIMEOUT_COMMAND    "command: Deadline of a single bus command. (100ms)"
+#define HELP_TIMEOUT_BATCH      "batch: Deadline of a batch, read-reg and write-reg commands. (1000ms)"
+
+#define HELP_TIMEOUT_NOTE1      "\nTimeouts are kept by the device until it is reset or disconnected.\n"
+
+// Help for SAMPLE command.
+
+#define HELP_SAMPLE_FORMAT      "Format: sample {config [PERIOD] [ADDRESS] [REGISTER] [LENGTH]... | start | stop | read}"
+#define HELP_SAMPLE_INTRO1      "\nRead a list of slave registers periodically on the device. The hardware timer of"
+#define HELP_SAMPLE_INTRO2      "the device triggers the reads in every \033[1m\033[37m[PERIOD]\033[0m milliseconds (1 - 60000) and the"
+#define HELP_SAMPLE_INTRO3      "samples are buffered on the device until those are drained by the host."
+
+#define HELP_SAMPLE_CONFIG      "\nconfig: Set the period and up to 8 registers (30 data bytes in total) to sample."
+#define HELP_SAMPLE_START       "start: Clear the buffered samples and start sampling."
+#define HELP_SAMPLE_STOP        "stop: Stop sampling."
+#define HELP_SAMPLE_READ        "read: Show the buffered samples with the sequence number. (default)"
+
+#define HELP_SAMPLE_NOTE1       "\nSamples are skipped while a bus transaction is held by the host. Skipped samples"
+#define HELP_SAMPLE_NOTE2       "and the samples dropped due to the full buffer are reported by the read.\n"
+
+// Help for STATS command.
+
+#define HELP_STATS_FORMAT       "Format: stats {reset}"
+#define HELP_STATS_INTRO1       "\nShow the performance counters of the device. Counters are collected from the power"
+#define HELP_STATS_INTRO2       "up of the device or from the last reset of the counters."
+
+#define HELP_STATS_SERVICE      "\nUSB service calls: Number of USB service calls and the longest gap between two calls."
+#define HELP_STATS_BUS          "I2C wait iterations: Service loop iterations spent on waiting for the I2C hardware."
+#define HELP_STATS_ERRORS       "Timeouts, bus busy and arbitration lost: Number of I2C failures of each type."
+#define HELP_STATS_QUEUE        "Rejected: Commands rejected by the full command queue, completed results hold their"
+#define HELP_STATS_QUEUE2       "slots until those are collected by the host."
+#define HELP_STATS_COMMANDS     "Command counters: Number of executed commands of each type."
+
+#define HELP_STATS_NOTE1        "\nreset: Clear the counters after showing the current values. Gaps above 50ms"
+#define HELP_STATS_NOTE2        "between the USB service calls may cause the host to lose the device.\n"
+
+// Help for DEVICE command.
+
+#define HELP_DEVICE_FORMAT  "Format: device {TARGET}"
+#define HELP_DEVICE_INTRO1  "\nSelect the device(s) which receive the commands when more than one I2C test"
+#define HELP_DEVICE_INTRO2  "terminal is connected. \033[1m\033[37m{TARGET}\033[0m is an optional, comma separated list of device"
+#define HELP_DEVICE_INTRO3  "indexes or names (serial numbers), or \033[1m\033[37mall\033[0m to broadcast the commands. (default)"
+
+#define HELP_DEVICE_PREFIX1 "\nA single command can be addressed to other device(s) with the \033[1m\033[37m@TARGET\033[0m prefix."
+#define HELP_DEVICE_PREFIX2 "For example:"
+#define HELP_DEVICE_PREFIX3 "\n\033[1m\033[37m @0,2 read-reg 0x50 0x00 4\033[0m"
+
+#define HELP_DEVICE_NOTE1   "\nEach device has an independent I/O worker, the devices in the target execute"
+#define HELP_DEVICE_NOTE2   "the command in parallel.\n"
+
 // Help for EXIT command.
 
 #define HELP_EXIT_FORMAT    "Format: exit"
@@ -25,6 +25,8 @@
 #include "termutil.h"
 #include "common.h"
 #include "strdef.h"
+#include "pollctl.h"
+#include "usbproto.h"
 
 #include <stdio.h>
 
@@ -39,9 +41,15 @@ void printDeviceStatusMsg(unsigned char errorCode)
     case RET_TIMEOUT_FAIL:
         printErrorMsg(DEV_COM_TIMEOUT);
         break;
+    case RET_BUS_BUSY_FAIL:
+        printErrorMsg(DEV_COM_BUS_BUSY);
+        break;
     case RET_UNKNOWN:
         printErrorMsg(DEV_COM_UNKNOWN);
         break;
+    case RET_QUEUE_FULL:
+        printErrorMsg(DEV_COM_QUEUE_FULL);
+        break;
     // I2C specific status codes.
     case 0x08:
         printStatus(DEV_COM_START_TX);
@@ -80,4 +88,256 @@ void printDeviceStatusMsg(unsigned char errorCode)
     default:
         printf(ERROR_UNKNOWN_FORMATTER, errorCode, DEV_COM_UNKNOWN);
     }
+}
+
+unsigned char isDeviceFailure(unsigned char errorCode)
+{
+    switch(errorCode)
+    {
+    case RET_TIMEOUT_FAIL:
+    case RET_BUS_BUSY_FAIL:
+    case RET_UNKNOWN:
+    case RET_QUEUE_FULL:
+    case 0x20:  // Slave address with WRITE flag, NOT ACK.
+    case 0x30:  // Data byte transmitted, NOT ACK.
+    case 0x38:  // Arbitration lost.
+    case 0x48:  // Slave address with READ flag, NOT ACK.
+        return 1;
+    }
+
+    return 0;
+}
+
+void printBatchStatusMsg(const unsigned char *request, const unsigned char *response)
+{
+    unsigned char opPos;
+    const unsigned char *reqOp = request + USB_REQ_HEADER_SIZE;
+    const unsigned char *respOp = response + USB_RESP_HEADER_SIZE;
+
+    // Response DATA0 contains the number of operations executed by the device.
+    for(opPos = 0; (opPos < response[3]) && (opPos < request[2]); opPos++)
+    {
+        printDeviceStatusMsg(respOp[0]);
+
+        // On READ operation show received data.
+        if(reqOp[0] == USB_CMD_I2C_READ)
+        {
+            printData(respOp[1]);
+        }
+
+        reqOp += 2;
+        respOp += 2;
+    }
+
+    if(response[3] < request[2])
+    {
+        // Device stops the batch due to an error.
+        printf(ERROR_BATCH_FORMATTER, response[3], request[2]);
+    }
+}
+
+void printDataBlock(const unsigned char *data, unsigned int length)
+{
+    unsigned int dataPos;
+
+    // Print data bytes as rows of 16 values.
+    for(dataPos = 0; dataPos < length; dataPos++)
+    {
+        if((dataPos % 16) == 0)
+        {
+            printf((dataPos == 0) ? "Data:" : "\n     ");
+        }
+
+        printf(" 0x%02x", data[dataPos]);
+    }
+
+    printf("\n");
+}
+
+void printScanResult(const unsigned char *response)
+{
+    unsigned char addr, scanStatus;
+    const unsigned char *addrStatus = response + USB_RESP_HEADER_SIZE + SCAN_BITMAP_SIZE;
+
+    // Print address map in the same layout as i2cdetect, 16 addresses per row.
+    printf("   ");
+    for(addr = 0; addr < 16; addr++)
+    {
+        printf("  %x", addr);
+    }
+
+    for(addr = 0; addr < 0x80; addr++)
+    {
+        if((addr % 16) == 0)
+        {
+            printf("\n%02x:", addr);
+        }
+
+        if((addr < SCAN_FIRST_ADDR) || (addr > SCAN_LAST_ADDR))
+        {
+            // Reserved address, not probed by the device.
+            printf("   ");
+            continue;
+        }
+
+        scanStatus = (addrStatus[addr >> 2] >> ((addr & 0x03) * 2)) & 0x03;
+        switch(scanStatus)
+        {
+        case SCAN_STATUS_ACK:
+            printf(" %02x", addr);
+            break;
+        case SCAN_STATUS_TIMEOUT:
+            printf(" TO");
+            break;
+        case SCAN_STATUS_ERROR:
+            printf(" XX");
+            break;
+        default:
+            printf(" --");
+        }
+    }
+
+    // Response DATA0 contains the number of slave devices found.
+    printf("\n" DEV_COM_SCAN_FOUND, response[3]);
+}
+
+void showPollStatus()
+{
+    struct PollStatistics stats;
+
+    switch(getPollMode())
+    {
+    case POLL_MODE_IMMEDIATE:
+        printf(MSG_POLL_MODE, "immediate");
+        break;
+    case POLL_MODE_SPIN:
+        printf(MSG_POLL_MODE, "spin-then-backoff");
+        break;
+    case POLL_MODE_BACKOFF:
+        printf(MSG_POLL_MODE, "exponential backoff");
+        break;
+    case POLL_MODE_EVENT:
+        printf(MSG_POLL_MODE, "interrupt-IN event");
+        break;
+    }
+
+    getPollStatistics(&stats);
+    printf(MSG_POLL_STATS, stats.commandCount, stats.lastPollCount, stats.maxPollCount, stats.averagePollCount);
+}
+
+void printSampleBlock(const unsigned char *response)
+{
+    unsigned char framePos, frameSize;
+    const unsigned char *block = response + USB_RESP_HEADER_SIZE;
+    const unsigned char *frame = block + SAMPLE_BLOCK_HEADER;
+
+    // Block format: MISSED | FRAME SIZE | FRAMES..., DATA0 contains the number of frames.
+    frameSize = block[1];
+    if(block[0] > 0)
+    {
+        printf(DEV_COM_SAMPLE_MISSED, block[0]);
+    }
+
+    if(frameSize <= SAMPLE_FRAME_HEADER)
+    {
+        // Sampling list is not configured.
+        return;
+    }
+
+    for(framePos = 0; framePos < response[3]; framePos++, frame += frameSize)
+    {
+        // Frame format: SEQUENCE | STATUS | DATA...
+        printf("%3d: ", frame[0]);
+        if(isDeviceFailure(frame[1]))
+        {
+            printDeviceStatusMsg(frame[1]);
+            continue;
+        }
+
+        printDataBlock(frame + SAMPLE_FRAME_HEADER, frameSize - SAMPLE_FRAME_HEADER);
+    }
+}
+
+void printDeviceStatistics(const unsigned char *response)
+{
+    // Names of the command counters, indexed by the opcode - 1.
+    static const char *opNames[STATS_OPCODE_COUNT] = {"init", "start", "stop", "write-address", "write", "read", "set-voltage", 
+        "get-voltage", "reset", "batch", "read-reg", "write-reg", "timeout", "scan", "read-bulk", "write-bulk", "sample-config", 
+        "sample-control", "sample-read", "stats"};
+    struct DevStatistics stats;
+    unsigned char opPos;
+
+    getDevStatistics(response + USB_RESP_HEADER_SIZE, &stats);
+
+    printf(MSG_STATS_SERVICE, (unsigned long)stats.usbPolls, ((double)stats.maxPollGap * STATS_TICK_US) / 1000.0);
+    printf(MSG_STATS_BUS, (unsigned long)stats.waitIterations, stats.timeouts, stats.busBusy, stats.arbitrationLost);
+    printf(MSG_STATS_QUEUE, stats.rejected);
+
+    // Only the commands executed since the last reset are listed.
+    for(opPos = 0; opPos < STATS_OPCODE_COUNT; opPos++)
+    {
+        if(stats.commands[opPos] > 0)
+        {
+            printf(MSG_STATS_COMMAND, opNames[opPos], stats.commands[opPos]);
+        }
+    }
+}
+
+void printDeviceList(const char **names, unsigned int count, unsigned int target)
+{
+    unsigned int devPos;
+
+    // Devices which receive the commands are marked with "*".
+    for(devPos = 0; devPos < count; devPos++)
+    {
+        printf(MSG_DEVICE_ENTRY, (target & (1U << devPos)) ? '*' : ' ', devPos, names[devPos]);
+    }
+}
+
+void printCaptureRecord(const struct CaptureRecord *record)
+{
+    const unsigned char reqPayloadLength = (record->reqLength > USB_REQ_HEADER_SIZE) ? (record->reqLength - USB_REQ_HEADER_SIZE) : 0;
+    const unsigned char respPayloadLength = (record->respLength > USB_RESP_HEADER_SIZE) ? (record->respLength - USB_RESP_HEADER_SIZE) : 0;
+
+    printf(MSG_CAPTURE_RECORD, (unsigned long long)(record->timestamp / 1000000000ULL), (unsigned long long)((record->timestamp % 1000000000ULL) / 1000),
+        record->deviceId, record->command, record->data, record->tag, ((record->execStatus == EXEC_SUCCESS) ? "OK" : "FAIL"), 
+        record->status, record->respData, record->pollCount, record->latencyUs);
+
+    // Payload lengths are limited to the record size to handle the damaged records.
+    if(reqPayloadLength > 0)
+    {
+        printf("  >> ");
+        printDataBlock(record->reqPayload, (reqPayloadLength > CAPTURE_PAYLOAD_SIZE) ? CAPTURE_PAYLOAD_SIZE : reqPayloadLength);
+    }
+
+    if(respPayloadLength > 0)
+    {
+        printf("  << ");
+        printDataBlock(record->respPayload, (respPayloadLength > CAPTURE_PAYLOAD_SIZE) ? CAPTURE_PAYLOAD_SIZE : respPayloadLength);
+    }
+}
+
+void printReplayResult(const struct CaptureRecord *record, const struct ReplayResult *result)
+{
+    if(result->diffFlags == 0)
+    {
+        // Only the divergences are reported.
+        return;
+    }
+
+    printf(MSG_REPLAY_DIFF, (unsigned long long)result->index, record->deviceId, record->command, record->data, 
+        ((record->execStatus == EXEC_SUCCESS) ? "OK" : "FAIL"), record->status, record->respData, 
+        ((result->execStatus == EXEC_SUCCESS) ? "OK" : "FAIL"), result->status, result->respData,
+        ((result->diffFlags & REPLAY_DIFF_DATA) && (result->respData == record->respData)) ? " (payload)" : "");
+}
+
+void printReplayStatistics(const struct ReplayStatistics *stats)
+{
+    printf(MSG_REPLAY_SUMMARY, stats->replayCount, stats->skipCount, stats->execDiffCount, stats->statusDiffCount, stats->dataDiffCount);
+
+    if(stats->replayCount > 0)
+    {
+        printf(MSG_REPLAY_LATENCY, ((double)stats->totalLatencyDeltaUs / stats->replayCount), (long long)stats->minLatencyDeltaUs, 
+            (long long)stats->maxLatencyDeltaUs, ((double)stats->elapsedUs / 1000000.0));
+    }
 }
\ No newline at end of file
@@ -25,15 +25,31 @@
 #ifndef I2C_TERMINAL_UTILITIES
 #define I2C_TERMINAL_UTILITIES
 
+#include "caplog.h"
+#include "replay.h"
+
 #define ERROR_TEXT_FORMATTER        "\x1b[31m%s\x1b[0m\n"
 #define ERROR_TEXT_FORMATTER_EX     "\x1b[31m%s: %s\x1b[0m\n"
 #define ERROR_UNKNOWN_FORMATTER     "\x1b[31m0x%x: %s\x1b[0m\n"
+#define ERROR_BATCH_FORMATTER       "\x1b[31m" DEV_COM_BATCH_ABORTED "\x1b[0m\n"
+#define ERROR_BULK_WRITE_FORMATTER  "\x1b[31m" DEV_COM_BULK_WRITE_ABORTED "\x1b[0m\n"
 #define WARNING_TEXT_FORMATTER      "%s\n"
 #define STATUS_TEXT_FORMATTER       "\x1b[33m%s\x1b[0m\n"
 #define HELP_TEXT_FORMATTER         "%s\n"
 #define HELP_CMDFORMAT_FORMATTER    "\x1B[33m%s\x1B[0m\n"
 
 void printDeviceStatusMsg(unsigned char errorCode);
+unsigned char isDeviceFailure(unsigned char errorCode);
+void printBatchStatusMsg(const unsigned char *request, const unsigned char *response);
+void printDataBlock(const unsigned char *data, unsigned int length);
+void printScanResult(const unsigned char *response);
+void showPollStatus();
+void printSampleBlock(const unsigned char *response);
+void printDeviceStatistics(const unsigned char *response);
+void printDeviceList(const char **names, unsigned int count, unsigned int target);
+void printCaptureRecord(const struct CaptureRecord *record);
+void printReplayResult(const struct CaptureRecord *record, const struct ReplayResult *result);
+void printReplayStatistics(const struct ReplayStatistics *stats);
 
 #define printErrorMsg(x) printf(ERROR_TEXT_FORMATTER, x)
 #define printCommandError(m, p) printf(ERROR_TEXT_FORMATTER_EX, p, m)
@@ -0,0 +1,141 @@
+//----------------------------------------------------------------------------------
+// I2C Test Terminal - Device Transport Layer.
+//
+// Copyright (c) 2021 Dilshan R Jayakody [jayakody2000lk@gmail.com].
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//----------------------------------------------------------------------------------
+
+#include "transport.h"
+#include "devlink.h"
+#include "devsim.h"
+
+#include <pthread.h>
+#include <stddef.h>
+#include <string.h>
+
+// Available backends, built-in backends are always registered.
+static const struct TransportOps *transportBackends[TRANSPORT_MAX_BACKENDS] = {&hidrawTransportOps, &simTransportOps};
+static unsigned int transportBackendCount = 2;
+static pthread_mutex_t transportLock = PTHREAD_MUTEX_INITIALIZER;
+
+EXEC_STATUS registerTransport(const struct TransportOps *ops)
+{
+    EXEC_STATUS status = EXEC_FAIL;
+
+    pthread_mutex_lock(&transportLock);
+
+    // Backend names must be unique.
+    if((transportBackendCount < TRANSPORT_MAX_BACKENDS) && (findTransport(ops->name) == NULL))
+    {
+        transportBackends[transportBackendCount++] = ops;
+        status = EXEC_SUCCESS;
+    }
+
+    pthread_mutex_unlock(&transportLock);
+    return status;
+}
+
+const struct TransportOps *findTransport(const char *name)
+{
+    unsigned int backendPos;
+
+    for(backendPos = 0; backendPos < transportBackendCount; backendPos++)
+    {
+        if(strcmp(transportBackends[backendPos]->name, name) == 0)
+        {
+            return transportBackends[backendPos];
+        }
+    }
+
+    return NULL;
+}
+
+EXEC_STATUS openTransport(struct Transport *transport, const char *name, const char *target)
+{
+    transport->ops = findTransport(name);
+    transport->deviceHandler = -1;
+    transport->context = NULL;
+    transport->transferCount = 0;
+
+    if(transport->ops == NULL)
+    {
+        // Unknown backend.
+        return EXEC_FAIL;
+    }
+
+    if(transport->ops->open(transport, target) == EXEC_FAIL)
+    {
+        transport->ops = NULL;
+        return EXEC_FAIL;
+    }
+
+    return EXEC_SUCCESS;
+}
+
+void closeTransport(struct Transport *transport)
+{
+    if(transport->ops != NULL)
+    {
+        transport->ops->close(transport);
+        transport->ops = NULL;
+    }
+}
+
+EXEC_STATUS submitTransportRequest(struct Transport *transport, const unsigned char *request)
+{
+    return transport->ops->submit(transport, request);
+}
+
+EXEC_STATUS waitTransportResponse(struct Transport *transport, const unsigned char *request, unsigned char *response, unsigned int *pollCount)
+{
+    if(pollCount != NULL)
+    {
+        *pollCount = 0;
+    }
+
+    return transport->ops->wait(transport, request, response, pollCount);
+}
+
+EXEC_STATUS execTransportRequest(struct Transport *transport, const unsigned char *request, unsigned char *response, unsigned int *pollCount)
+{
+    if(pollCount != NULL)
+    {
+        *pollCount = 0;
+    }
+
+    // Request is accepted by the device, wait for its response.
+    if(submitTransportRequest(transport, request) == EXEC_FAIL)
+    {
+        return EXEC_FAIL;
+    }
+
+    return waitTransportResponse(transport, request, response, pollCount);
+}
+
+unsigned int getTransportCapabilities(const struct Transport *transport)
+{
+    return (transport->ops != NULL) ? transport->ops->capabilities : 0;
+}
+
+unsigned int getTransportQueueDepth(const struct Transport *transport)
+{
+    // Requests which can be submitted before waiting for the response of the first one.
+    return (getTransportCapabilities(transport) & TRANSPORT_CAP_QUEUE) ? DEV_QUEUE_SIZE : 1;
+}
\ No newline at end of file
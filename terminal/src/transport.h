@@ -0,0 +1,75 @@
+//----------------------------------------------------------------------------------
+// I2C Test Terminal - Device Transport Layer.
+//
+// Copyright (c) 2021 Dilshan R Jayakody [jayakody2000lk@gmail.com].
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//----------------------------------------------------------------------------------
+
+#ifndef I2C_TERMINAL_TRANSPORT
+#define I2C_TERMINAL_TRANSPORT
+
+#include "common.h"
+
+// Built-in transport backends.
+#define TRANSPORT_HIDRAW    "hidraw"    // Terminal device over the HIDRAW feature reports.
+#define TRANSPORT_SIM       "sim"       // In-process device simulator.
+
+#define TRANSPORT_MAX_BACKENDS  8
+
+// Transport capabilities.
+#define TRANSPORT_CAP_EVENTS    0x01    // Completion is signaled by the device (interrupt-IN records).
+#define TRANSPORT_CAP_QUEUE     0x02    // Up to DEV_QUEUE_SIZE requests are submitted before waiting for the responses.
+#define TRANSPORT_CAP_HARDWARE  0x04    // Requests are executed on a physical I2C bus.
+
+struct Transport;
+
+// Backend of the transport layer. Submit sends the request frame to the device and wait returns the
+// response (HIDRAW layout, report number first) of the submitted request. Backends with TRANSPORT_CAP_QUEUE
+// accept several submitted requests, request buffers must be valid until the wait.
+struct TransportOps
+{
+    const char *name;
+    unsigned int capabilities;
+    EXEC_STATUS (*open)(struct Transport *transport, const char *target);
+    EXEC_STATUS (*submit)(struct Transport *transport, const unsigned char *request);
+    EXEC_STATUS (*wait)(struct Transport *transport, const unsigned char *request, unsigned char *response, unsigned int *pollCount);
+    void (*close)(struct Transport *transport);
+};
+
+struct Transport
+{
+    const struct TransportOps *ops;
+    int deviceHandler;              // File handler of the device, if used by the backend.
+    void *context;                  // Backend specific state.
+    unsigned long transferCount;    // USB transfers of the backend (requests, resends, feature reports and completion records).
+};
+
+EXEC_STATUS registerTransport(const struct TransportOps *ops);
+const struct TransportOps *findTransport(const char *name);
+
+EXEC_STATUS openTransport(struct Transport *transport, const char *name, const char *target);
+void closeTransport(struct Transport *transport);
+EXEC_STATUS submitTransportRequest(struct Transport *transport, const unsigned char *request);
+EXEC_STATUS waitTransportResponse(struct Transport *transport, const unsigned char *request, unsigned char *response, unsigned int *pollCount);
+EXEC_STATUS execTransportRequest(struct Transport *transport, const unsigned char *request, unsigned char *response, unsigned int *pollCount);
+unsigned int getTransportCapabilities(const struct Transport *transport);
+unsigned int getTransportQueueDepth(const struct Transport *transport);
+
+#endif /* I2C_TERMINAL_TRANSPORT */
\ No newline at end of file
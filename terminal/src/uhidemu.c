@@ -0,0 +1,532 @@
+//----------------------------------------------------------------------------------
+// I2C Test Terminal - UHID Device Emulator.
+//
+// Copyright (c) 2021 Dilshan R Jayakody [jayakody2000lk@gmail.com].
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//----------------------------------------------------------------------------------
+
+#define _GNU_SOURCE
+
+#include "uhidemu.h"
+#include "termutil.h"
+#include "strdef.h"
+
+#include <linux/uhid.h>
+#include <linux/input.h>
+
+#include <getopt.h>
+#include <signal.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+// HID report descriptor of the device (ref: usbHidReportDescriptor in i2ctester.c).
+static const unsigned char emuReportDescriptor[] =
+{
+    0x06, 0x00, 0xff,              // USAGE_PAGE (Generic Desktop)
+    0x09, 0x01,                    // USAGE (Vendor Usage 1)
+    0xa1, 0x01,                    // COLLECTION (Application)
+    0x15, 0x00,                    //   LOGICAL_MINIMUM (0)
+    0x26, 0xff, 0x00,              //   LOGICAL_MAXIMUM (255)
+    0x75, 0x08,                    //   REPORT_SIZE (8)
+    0x95, 0x80,                    //   REPORT_COUNT (128)
+    0x09, 0x00,                    //   USAGE (Undefined)
+    0xb2, 0x02, 0x01,              //   FEATURE (Data,Var,Abs,Buf)
+    0x95, 0x08,                    //   REPORT_COUNT (8)
+    0x09, 0x00,                    //   USAGE (Undefined)
+    0x81, 0x02,                    //   INPUT (Data,Var,Abs)
+    0xc0                           // END_COLLECTION
+};
+
+static const struct option emuOptions[] = 
+{
+    {"serial", required_argument, NULL, 's'},
+    {"slaves", required_argument, NULL, 'm'},
+    {"overhead", required_argument, NULL, 'o'},
+    {"bus-clock", required_argument, NULL, 'k'},
+    {"help", no_argument, NULL, 'h'},
+    {NULL, 0, NULL, 0}
+};
+
+static volatile sig_atomic_t emuActive;
+
+static void stopEmuDevice(int signal)
+{
+    emuActive = 0;
+}
+
+static uint64_t getEmuClock()
+{
+    return getCaptureClock() / 1000;
+}
+
+static EXEC_STATUS writeEmuEvent(struct EmuDevice *emuDevice, const struct uhid_event *event)
+{
+    ssize_t writeSize;
+
+    do
+    {
+        writeSize = write(emuDevice->uhidHandle, event, sizeof(struct uhid_event));
+    }
+    while((writeSize < 0) && (errno == EINTR));
+
+    return (writeSize == sizeof(struct uhid_event)) ? EXEC_SUCCESS : EXEC_FAIL;
+}
+
+EXEC_STATUS createEmuDevice(struct EmuDevice *emuDevice, const char *serialNumber, const char *slaves)
+{
+    struct uhid_event event;
+
+    emuDevice->uhidHandle = -1;
+    emuDevice->simDevice = createSimDevice();
+
+    if((emuDevice->simDevice == NULL) || (addSimSlaves(emuDevice->simDevice, slaves) == EXEC_FAIL))
+    {
+        printCommandError(SIM_SLAVES_INVALID, slaves);
+        releaseEmuDevice(emuDevice);
+        return EXEC_FAIL;
+    }
+
+    emuDevice->uhidHandle = open(EMU_UHID_PATH, O_RDWR | O_CLOEXEC);
+    if(emuDevice->uhidHandle < 0)
+    {
+        printCommandError(EMU_UHID_NOT_OPEN, EMU_UHID_PATH);
+        releaseEmuDevice(emuDevice);
+        return EXEC_FAIL;
+    }
+
+    // Virtual device is exposed with the same identity as the USB device, so udev lookup of the terminal finds it.
+    memset(&event, 0, sizeof(event));
+    event.type = UHID_CREATE2;
+    strncpy((char *)event.u.create2.name, EMU_DEVICE_NAME, sizeof(event.u.create2.name) - 1);
+    strncpy((char *)event.u.create2.phys, EMU_UHID_PATH, sizeof(event.u.create2.phys) - 1);
+    strncpy((char *)event.u.create2.uniq, serialNumber, sizeof(event.u.create2.uniq) - 1);
+    memcpy(event.u.create2.rd_data, emuReportDescriptor, sizeof(emuReportDescriptor));
+    event.u.create2.rd_size = sizeof(emuReportDescriptor);
+    event.u.create2.bus = BUS_USB;
+    event.u.create2.vendor = I2C_TERMINAL_DEV_VID;
+    event.u.create2.product = I2C_TERMINAL_DEV_PID;
+    event.u.create2.version = EMU_DEVICE_VERSION;
+
+    if(writeEmuEvent(emuDevice, &event) == EXEC_FAIL)
+    {
+        printErrorMsg(EMU_CREATE_FAIL);
+        releaseEmuDevice(emuDevice);
+        return EXEC_FAIL;
+    }
+
+    return EXEC_SUCCESS;
+}
+
+void releaseEmuDevice(struct EmuDevice *emuDevice)
+{
+    struct uhid_event event;
+
+    if(emuDevice->uhidHandle >= 0)
+    {
+        // Remove the virtual device before closing the uhid handle.
+        memset(&event, 0, sizeof(event));
+        event.type = UHID_DESTROY;
+        writeEmuEvent(emuDevice, &event);
+
+        close(emuDevice->uhidHandle);
+        emuDevice->uhidHandle = -1;
+    }
+
+    releaseSimDevice(emuDevice->simDevice);
+    emuDevice->simDevice = NULL;
+}
+
+static unsigned int getEmuBusClock(struct EmuDevice *emuDevice)
+{
+    if(emuDevice->busClock != EMU_BUS_CLOCK_AUTO)
+    {
+        return emuDevice->busClock;
+    }
+
+    // Follow the bus speed selected by the host.
+    switch(emuDevice->simDevice->comSpeed)
+    {
+    case TWI_COM_SPEED_250:
+        return 250;
+    case TWI_COM_SPEED_400:
+        return 400;
+    }
+
+    return 100;
+}
+
+static void dequeueEmuResult(struct EmuDevice *emuDevice)
+{
+    // Release the oldest completed slot, completion record of it is not required anymore.
+    if(emuDevice->eventHead == emuDevice->resultTail)
+    {
+        emuDevice->eventHead++;
+    }
+
+    emuDevice->resultTail++;
+}
+
+static EXEC_STATUS sendEmuCompletion(struct EmuDevice *emuDevice, const unsigned char *header)
+{
+    struct uhid_event event;
+
+    // Completion record format:
+    // SIGNATURE | COMMAND | STATUS | DATA | TAG | RESERVED
+    memset(&event, 0, sizeof(event));
+    event.type = UHID_INPUT2;
+    event.u.input2.size = USB_EVENT_RECORD_SIZE;
+    memcpy(event.u.input2.data, header, USB_RESP_HEADER_SIZE);
+
+    emuDevice->eventCount++;
+    return writeEmuEvent(emuDevice, &event);
+}
+
+static EXEC_STATUS updateEmuQueue(struct EmuDevice *emuDevice)
+{
+    uint64_t currentTime = getEmuClock();
+    EXEC_STATUS status = EXEC_SUCCESS;
+
+    // Commands are completed in order, each one after the completion time of it.
+    while((emuDevice->execHead != emuDevice->recvHead) && (emuDevice->slots[emuDevice->execHead & EMU_QUEUE_MASK].doneTime <= currentTime))
+    {
+        emuDevice->execHead++;
+    }
+
+    if(!emuDevice->opened)
+    {
+        // Interrupt-IN reports are delivered only while the HIDRAW node is open.
+        return EXEC_SUCCESS;
+    }
+
+    if(emuDevice->rejectPending)
+    {
+        status = sendEmuCompletion(emuDevice, emuDevice->rejectRecord);
+        emuDevice->rejectPending = 0;
+    }
+
+    while((status == EXEC_SUCCESS) && (emuDevice->eventHead != emuDevice->execHead))
+    {
+        status = sendEmuCompletion(emuDevice, &emuDevice->slots[emuDevice->eventHead & EMU_QUEUE_MASK].response[1]);
+        emuDevice->eventHead++;
+    }
+
+    return status;
+}
+
+static void setEmuReport(struct EmuDevice *emuDevice, const unsigned char *request, unsigned short size)
+{
+    unsigned char command[USB_REPORT_SIZE];
+    struct EmuSlot *slot;
+    unsigned long busCycles;
+    unsigned int busClock;
+    uint64_t startTime;
+
+    // Short reports are padded as same as the remaining bytes of the firmware slot.
+    memset(command, 0, sizeof(command));
+    memcpy(command, request, (size > USB_REPORT_SIZE) ? USB_REPORT_SIZE : size);
+
+    if((unsigned char)(emuDevice->recvHead - emuDevice->resultTail) >= EMU_QUEUE_SIZE)
+    {
+        // Command queue is full (uncollected results occupy their slots), report the rejection with the command and tag.
+        emuDevice->rejectRecord[0] = command[0];
+        emuDevice->rejectRecord[1] = command[1];
+        emuDevice->rejectRecord[2] = RET_QUEUE_FULL;
+        emuDevice->rejectRecord[3] = 0x00;
+        emuDevice->rejectRecord[4] = command[4];
+        emuDevice->rejectPending = ((command[0] == SYS_SIGNATURE) && (command[1] != USB_CMD_NONE));
+        emuDevice->rejectCount++;
+        emuDevice->simDevice->stats.rejected++;
+        return;
+    }
+
+    // Simulator executes the command right away, result is held in the slot until the modelled completion time.
+    slot = &emuDevice->slots[emuDevice->recvHead & EMU_QUEUE_MASK];
+    busCycles = emuDevice->simDevice->busCycles;
+
+    if(sendSimRequest(emuDevice->simDevice, command, slot->response, NULL) == EXEC_FAIL)
+    {
+        // Firmware drops the malformed requests without using the slot.
+        emuDevice->malformedCount++;
+        return;
+    }
+
+    // Response is returned with the report number (ref: usbFunctionRead in firmware).
+    slot->response[0] = 0x00;
+    slot->length = getUSBResponseLength(command) + 1;
+
+    // Commands are executed one after the other, so the next command starts after the completion of the previous one.
+    startTime = getEmuClock();
+    startTime = (emuDevice->lastDone > startTime) ? emuDevice->lastDone : startTime;
+    busCycles = emuDevice->simDevice->busCycles - busCycles;
+    busClock = getEmuBusClock(emuDevice);
+
+    slot->doneTime = startTime + emuDevice->overhead + ((busClock > 0) ? ((busCycles * 1000) / busClock) : 0);
+    emuDevice->lastDone = slot->doneTime;
+
+    emuDevice->recvHead++;
+    emuDevice->commandCount++;
+}
+
+static void getEmuReport(struct EmuDevice *emuDevice, struct uhid_get_report_reply_req *reply)
+{
+    struct EmuSlot *slot;
+    unsigned char *header = &reply->data[1];
+
+    // Response data format:
+    // REPORT NUMBER | SIGNATURE | COMMAND | STATUS | DATA | TAG | PAYLOAD (optional)
+    reply->data[0] = 0x00;
+
+    if(emuDevice->rejectPending)
+    {
+        // Rejected command is reported before the queued results.
+        memcpy(header, emuDevice->rejectRecord, USB_RESP_HEADER_SIZE);
+        reply->size = USB_RESP_HEADER_SIZE + 1;
+        emuDevice->rejectPending = 0;
+    }
+    else if(emuDevice->resultTail != emuDevice->execHead)
+    {
+        // Return the oldest completed result and release it.
+        slot = &emuDevice->slots[emuDevice->resultTail & EMU_QUEUE_MASK];
+        memcpy(reply->data, slot->response, slot->length);
+        reply->size = slot->length;
+        dequeueEmuResult(emuDevice);
+    }
+    else
+    {
+        // No completed results, report the pending state of the next queued command.
+        slot = &emuDevice->slots[emuDevice->execHead & EMU_QUEUE_MASK];
+        header[0] = SYS_SIGNATURE;
+        header[1] = (emuDevice->execHead != emuDevice->recvHead) ? slot->response[2] : USB_CMD_NONE;
+        header[2] = RET_PENDING;
+        header[3] = 0x00;
+        header[4] = (emuDevice->execHead != emuDevice->recvHead) ? slot->response[5] : 0x00;
+        reply->size = USB_RESP_HEADER_SIZE + 1;
+    }
+}
+
+static EXEC_STATUS processEmuEvent(struct EmuDevice *emuDevice, const struct uhid_event *event)
+{
+    struct uhid_event reply;
+
+    memset(&reply, 0, sizeof(reply));
+
+    switch(event->type)
+    {
+    case UHID_OPEN:
+        emuDevice->opened = 1;
+        break;
+    case UHID_CLOSE:
+        emuDevice->opened = 0;
+        break;
+    case UHID_SET_REPORT:
+        // HIDRAW passes the first byte of the request (SIGNATURE) as the report number, data is the complete request.
+        if(event->u.set_report.rtype == UHID_FEATURE_REPORT)
+        {
+            setEmuReport(emuDevice, event->u.set_report.data, event->u.set_report.size);
+        }
+
+        reply.type = UHID_SET_REPORT_REPLY;
+        reply.u.set_report_reply.id = event->u.set_report.id;
+        reply.u.set_report_reply.err = (event->u.set_report.rtype == UHID_FEATURE_REPORT) ? 0 : EIO;
+        return writeEmuEvent(emuDevice, &reply);
+    case UHID_GET_REPORT:
+        reply.type = UHID_GET_REPORT_REPLY;
+        reply.u.get_report_reply.id = event->u.get_report.id;
+
+        if(event->u.get_report.rtype == UHID_FEATURE_REPORT)
+        {
+            // Completion time of the queued commands is checked before the response.
+            updateEmuQueue(emuDevice);
+            getEmuReport(emuDevice, &reply.u.get_report_reply);
+        }
+        else
+        {
+            reply.u.get_report_reply.err = EIO;
+        }
+
+        return writeEmuEvent(emuDevice, &reply);
+    }
+
+    // Start, stop and output reports are not used by the terminal.
+    return EXEC_SUCCESS;
+}
+
+EXEC_STATUS runEmuDevice(struct EmuDevice *emuDevice)
+{
+    struct uhid_event event;
+    struct pollfd uhidPoll;
+    struct timespec timeout, *pollTimeout;
+    uint64_t currentTime, doneTime;
+    ssize_t readSize;
+
+    uhidPoll.fd = emuDevice->uhidHandle;
+    uhidPoll.events = POLLIN;
+
+    while(emuActive)
+    {
+        if(updateEmuQueue(emuDevice) == EXEC_FAIL)
+        {
+            printErrorMsg(EMU_COM_FAIL);
+            return EXEC_FAIL;
+        }
+
+        // Wake up on the next uhid event or the completion time of the next command.
+        pollTimeout = NULL;
+        if(emuDevice->execHead != emuDevice->recvHead)
+        {
+            currentTime = getEmuClock();
+            doneTime = emuDevice->slots[emuDevice->execHead & EMU_QUEUE_MASK].doneTime;
+            doneTime = (doneTime > currentTime) ? (doneTime - currentTime) : 0;
+
+            timeout.tv_sec = doneTime / 1000000;
+            timeout.tv_nsec = (doneTime % 1000000) * 1000;
+            pollTimeout = &timeout;
+        }
+
+        if(ppoll(&uhidPoll, 1, pollTimeout, NULL) < 0)
+        {
+            if(errno == EINTR)
+            {
+                continue;
+            }
+
+            printErrorMsg(EMU_COM_FAIL);
+            return EXEC_FAIL;
+        }
+
+        if((uhidPoll.revents & POLLIN) == 0)
+        {
+            continue;
+        }
+
+        readSize = read(emuDevice->uhidHandle, &event, sizeof(event));
+        if(readSize < 0)
+        {
+            if((errno == EINTR) || (errno == EAGAIN))
+            {
+                continue;
+            }
+
+            printErrorMsg(EMU_COM_FAIL);
+            return EXEC_FAIL;
+        }
+
+        if((readSize >= (ssize_t)sizeof(event.type)) && (processEmuEvent(emuDevice, &event) == EXEC_FAIL))
+        {
+            printErrorMsg(EMU_COM_FAIL);
+            return EXEC_FAIL;
+        }
+    }
+
+    return EXEC_SUCCESS;
+}
+
+static EXEC_STATUS getEmuOption(const char *value, long minValue, long maxValue, long *option)
+{
+    char *endPos;
+
+    errno = 0;
+    *option = strtol(value, &endPos, 10);
+
+    if((errno != 0) || (endPos == value) || (*endPos != 0) || (*option < minValue) || (*option > maxValue))
+    {
+        printCommandError(EMU_PARAM_INVALID, value);
+        return EXEC_FAIL;
+    }
+
+    return EXEC_SUCCESS;
+}
+
+int main(int argc, char *argv[])
+{
+    struct EmuDevice emuDevice;
+    struct sigaction stopAction;
+    const char *serialNumber = EMU_DEFAULT_SERIAL;
+    const char *slaves = SIM_DEFAULT_SLAVES;
+    long optionValue;
+    int option;
+    EXEC_STATUS status;
+
+    memset(&emuDevice, 0, sizeof(emuDevice));
+    emuDevice.overhead = EMU_DEFAULT_OVERHEAD;
+    emuDevice.busClock = EMU_BUS_CLOCK_AUTO;
+
+    while((option = getopt_long(argc, argv, "s:m:o:k:h", emuOptions, NULL)) != -1)
+    {
+        switch(option)
+        {
+        case 's':
+            serialNumber = optarg;
+            break;
+        case 'm':
+            slaves = optarg;
+            break;
+        case 'o':
+            // Processing time of each command in microseconds.
+            if(getEmuOption(optarg, 0, 1000000, &optionValue) == EXEC_FAIL)
+            {
+                return 1;
+            }
+
+            emuDevice.overhead = optionValue;
+            break;
+        case 'k':
+            // SCL frequency used to model the bus transfers, 0 completes the transfers instantly.
+            if(getEmuOption(optarg, 0, 10000, &optionValue) == EXEC_FAIL)
+            {
+                return 1;
+            }
+
+            emuDevice.busClock = optionValue;
+            break;
+        default:
+            printf(EMU_MSG_USAGE, argv[0]);
+            return (option == 'h') ? 0 : 1;
+        }
+    }
+
+    // Remove the virtual device on termination of the emulator.
+    memset(&stopAction, 0, sizeof(stopAction));
+    stopAction.sa_handler = stopEmuDevice;
+    sigaction(SIGINT, &stopAction, NULL);
+    sigaction(SIGTERM, &stopAction, NULL);
+
+    if(createEmuDevice(&emuDevice, serialNumber, slaves) == EXEC_FAIL)
+    {
+        return 1;
+    }
+
+    printf(EMU_MSG_CREATED, serialNumber, slaves);
+    fflush(stdout);
+
+    emuActive = 1;
+    status = runEmuDevice(&emuDevice);
+
+    printf(EMU_MSG_SUMMARY, emuDevice.commandCount, emuDevice.rejectCount, emuDevice.malformedCount, emuDevice.eventCount);
+    releaseEmuDevice(&emuDevice);
+
+    return (status == EXEC_SUCCESS) ? 0 : 1;
+}
\ No newline at end of file
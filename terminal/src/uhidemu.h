@@ -0,0 +1,83 @@
+//----------------------------------------------------------------------------------
+// I2C Test Terminal - UHID Device Emulator.
+//
+// Copyright (c) 2021 Dilshan R Jayakody [jayakody2000lk@gmail.com].
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//----------------------------------------------------------------------------------
+
+#ifndef I2C_TERMINAL_UHID_EMULATOR
+#define I2C_TERMINAL_UHID_EMULATOR
+
+#include <stdint.h>
+
+#include "i2cterm.h"
+
+#define EMU_UHID_PATH           "/dev/uhid"
+#define EMU_DEVICE_NAME         "Dilshan I2C Terminal"
+#define EMU_DEVICE_VERSION      0x0100
+#define EMU_DEFAULT_SERIAL      "I2C-0001"
+
+// Command slots of the firmware (ref: CMD_QUEUE_SIZE in i2ctester.h).
+#define EMU_QUEUE_SIZE  4
+#define EMU_QUEUE_MASK  (EMU_QUEUE_SIZE - 1)
+
+// Time spent by the firmware on each command, excluding the bus transfer (in microseconds).
+#define EMU_DEFAULT_OVERHEAD    50
+
+// Bus clock follows the speed selected with the I2C init command.
+#define EMU_BUS_CLOCK_AUTO      -1
+
+// Command slot of the emulated device, result is released to the host after the completion time.
+struct EmuSlot
+{
+    unsigned char response[USB_GET_DATA_BUFFER_SIZE];
+    unsigned char length;           // Report number, header and the payload of the response.
+    uint64_t doneTime;              // CLOCK_MONOTONIC in microseconds.
+};
+
+struct EmuDevice
+{
+    int uhidHandle;
+    struct SimDevice *simDevice;
+    unsigned int overhead;
+    int busClock;
+
+    // Slot ring with the same counters as the firmware command queue.
+    struct EmuSlot slots[EMU_QUEUE_SIZE];
+    unsigned char recvHead;
+    unsigned char execHead;
+    unsigned char eventHead;
+    unsigned char resultTail;
+    unsigned char rejectRecord[USB_RESP_HEADER_SIZE];
+    unsigned char rejectPending;
+    uint64_t lastDone;
+
+    unsigned char opened;
+    unsigned long commandCount;
+    unsigned long rejectCount;
+    unsigned long malformedCount;
+    unsigned long eventCount;
+};
+
+EXEC_STATUS createEmuDevice(struct EmuDevice *emuDevice, const char *serialNumber, const char *slaves);
+void releaseEmuDevice(struct EmuDevice *emuDevice);
+EXEC_STATUS runEmuDevice(struct EmuDevice *emuDevice);
+
+#endif /* I2C_TERMINAL_UHID_EMULATOR */
\ No newline at end of file
@@ -0,0 +1,179 @@
+//----------------------------------------------------------------------------------
+// I2C Test Terminal - USB Protocol Frames.
+//
+// Copyright (c) 2021 Dilshan R Jayakody [jayakody2000lk@gmail.com].
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//----------------------------------------------------------------------------------
+
+#include "usbproto.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Tag of the last created request, 0 is used by the device after the reset.
+static atomic_uint lastTag = 0;
+
+unsigned char getNextTag()
+{
+    unsigned char tag;
+
+    // Skip tag 0 on wrap around.
+    while((tag = (unsigned char)(atomic_fetch_add(&lastTag, 1) + 1)) == 0);
+    return tag;
+}
+
+void setUSBBuffer(unsigned char *usbBuffer, unsigned char cmd, unsigned char data)
+{
+    memset(usbBuffer, 0, USB_SET_COMMAND_BUFFER_SIZE);
+    usbBuffer[0] = SYS_SIGNATURE;
+    usbBuffer[1] = cmd;
+    usbBuffer[2] = data;
+    usbBuffer[3] = SYS_END_SIGNATURE;
+    usbBuffer[4] = getNextTag();
+}
+
+unsigned char *createUSBBuffer(unsigned char cmd, unsigned char data)
+{
+    unsigned char* usbBuffer = malloc(USB_SET_COMMAND_BUFFER_SIZE);
+    setUSBBuffer(usbBuffer, cmd, data);
+
+    return usbBuffer;
+}
+
+unsigned char getUSBBufferLength(const unsigned char *usbBuffer)
+{
+    switch(usbBuffer[1])
+    {
+    case USB_CMD_BATCH:
+        // Batch request carries the COMMAND | DATA pair of each operation after the header.
+        return USB_REQ_HEADER_SIZE + (usbBuffer[2] * 2);
+    case USB_CMD_I2C_READ_REG:
+        // Register read request carries REGISTER | COUNT after the header.
+        return USB_REQ_HEADER_SIZE + 2;
+    case USB_CMD_I2C_WRITE_REG:
+        // Register write request carries REGISTER | COUNT | DATA... after the header.
+        return USB_REQ_HEADER_SIZE + 2 + usbBuffer[USB_REQ_HEADER_SIZE + 1];
+    case USB_CMD_SET_TIMEOUT:
+        // Timeout request carries the 16-bit timeout value (LSB first) after the header.
+        return USB_REQ_HEADER_SIZE + 2;
+    case USB_CMD_I2C_READ_BULK:
+        // Bulk read request carries the ACK flag of the last byte after the header.
+        return USB_REQ_HEADER_SIZE + 1;
+    case USB_CMD_I2C_WRITE_BULK:
+        // Bulk write request carries the data bytes after the header.
+        return USB_REQ_HEADER_SIZE + usbBuffer[2];
+    case USB_CMD_SAMPLE_CONFIG:
+        // Sampling configuration carries the period and ADDRESS | REGISTER | LENGTH of each entry.
+        return USB_REQ_HEADER_SIZE + SAMPLE_CONFIG_HEADER + (usbBuffer[2] * SAMPLE_ENTRY_SIZE);
+    }
+
+    return USB_REQ_HEADER_SIZE;
+}
+
+unsigned char getUSBResponseLength(const unsigned char *usbBuffer)
+{
+    switch(usbBuffer[1])
+    {
+    case USB_CMD_BATCH:
+        // Batch response carries the STATUS | DATA pair of each operation after the header.
+        return USB_RESP_HEADER_SIZE + (usbBuffer[2] * 2);
+    case USB_CMD_I2C_READ_REG:
+        // Register read response carries the received data bytes after the header.
+        return USB_RESP_HEADER_SIZE + usbBuffer[USB_REQ_HEADER_SIZE + 1];
+    case USB_CMD_I2C_READ_BULK:
+        // Bulk read response carries the received data bytes after the header.
+        return USB_RESP_HEADER_SIZE + usbBuffer[2];
+    case USB_CMD_I2C_SCAN:
+        // Scan response carries the presence bitmap and the status of each address.
+        return USB_RESP_HEADER_SIZE + SCAN_BITMAP_SIZE + SCAN_STATUS_SIZE;
+    case USB_CMD_SAMPLE_READ:
+        // Length of the sample block depends on the number of buffered frames.
+        return USB_REPORT_SIZE;
+    case USB_CMD_GET_STATS:
+        // Statistics response carries all the performance counters.
+        return USB_RESP_HEADER_SIZE + STATS_SIZE;
+    }
+
+    return USB_RESP_HEADER_SIZE;
+}
+
+static uint32_t getStatValue(const unsigned char **payload, unsigned char size)
+{
+    uint32_t value = 0;
+    unsigned char bytePos;
+
+    // Counter values are LSB first.
+    for(bytePos = 0; bytePos < size; bytePos++)
+    {
+        value |= (uint32_t)(*payload)[bytePos] << (bytePos * 8);
+    }
+
+    *payload += size;
+    return value;
+}
+
+static void setStatValue(unsigned char **payload, uint32_t value, unsigned char size)
+{
+    unsigned char bytePos;
+
+    for(bytePos = 0; bytePos < size; bytePos++)
+    {
+        (*payload)[bytePos] = (value >> (bytePos * 8)) & 0xFF;
+    }
+
+    *payload += size;
+}
+
+void getDevStatistics(const unsigned char *payload, struct DevStatistics *stats)
+{
+    unsigned char opPos;
+
+    stats->usbPolls = getStatValue(&payload, 4);
+    stats->waitIterations = getStatValue(&payload, 4);
+    stats->maxPollGap = getStatValue(&payload, 2);
+    stats->timeouts = getStatValue(&payload, 2);
+    stats->busBusy = getStatValue(&payload, 2);
+    stats->arbitrationLost = getStatValue(&payload, 2);
+    stats->rejected = getStatValue(&payload, 2);
+
+    for(opPos = 0; opPos < STATS_OPCODE_COUNT; opPos++)
+    {
+        stats->commands[opPos] = getStatValue(&payload, 2);
+    }
+}
+
+void setDevStatistics(unsigned char *payload, const struct DevStatistics *stats)
+{
+    unsigned char opPos;
+
+    setStatValue(&payload, stats->usbPolls, 4);
+    setStatValue(&payload, stats->waitIterations, 4);
+    setStatValue(&payload, stats->maxPollGap, 2);
+    setStatValue(&payload, stats->timeouts, 2);
+    setStatValue(&payload, stats->busBusy, 2);
+    setStatValue(&payload, stats->arbitrationLost, 2);
+    setStatValue(&payload, stats->rejected, 2);
+
+    for(opPos = 0; opPos < STATS_OPCODE_COUNT; opPos++)
+    {
+        setStatValue(&payload, stats->commands[opPos], 2);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,54 @@
+//----------------------------------------------------------------------------------
+// I2C Test Terminal - USB Protocol Frames.
+//
+// Copyright (c) 2021 Dilshan R Jayakody [jayakody2000lk@gmail.com].
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//----------------------------------------------------------------------------------
+
+#ifndef I2C_TERMINAL_USB_PROTOCOL
+#define I2C_TERMINAL_USB_PROTOCOL
+
+#include <stdint.h>
+
+#include "common.h"
+
+// Decoded performance counters of the device (ref: USB_CMD_GET_STATS).
+struct DevStatistics
+{
+    uint32_t usbPolls;
+    uint32_t waitIterations;
+    uint16_t maxPollGap;            // Timer1 ticks (STATS_TICK_US).
+    uint16_t timeouts;
+    uint16_t busBusy;
+    uint16_t arbitrationLost;
+    uint16_t rejected;
+    uint16_t commands[STATS_OPCODE_COUNT];
+};
+
+unsigned char getNextTag();
+void setUSBBuffer(unsigned char *usbBuffer, unsigned char cmd, unsigned char data);
+unsigned char *createUSBBuffer(unsigned char cmd, unsigned char data);
+unsigned char getUSBBufferLength(const unsigned char *usbBuffer);
+unsigned char getUSBResponseLength(const unsigned char *usbBuffer);
+
+void getDevStatistics(const unsigned char *payload, struct DevStatistics *stats);
+void setDevStatistics(unsigned char *payload, const struct DevStatistics *stats);
+
+#endif /* I2C_TERMINAL_USB_PROTOCOL */